@@ -0,0 +1,61 @@
+/**
+ * @file AllocationCounter.cpp
+ * @brief 堆分配计数实现
+ */
+
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<size_t> g_allocations{0};
+    
+    void* allocate(size_t size)
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1))
+        {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+size_t AllocationCounter::count()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+// 只替换普通版本：nothrow 版本的默认实现会转调这里，
+// 对齐版本（超过 __STDCPP_DEFAULT_NEW_ALIGNMENT__）仍使用标准库实现
+void* operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,19 @@
+/**
+ * @file AllocationCounter.h
+ * @brief 堆分配计数
+ * 
+ * 替换全局 operator new，统计进程内的堆分配次数，用于剖析各阶段的分配开销。
+ * 在 Windows 上各 DLL 使用各自的 operator new，只能统计本程序内的分配
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace AllocationCounter
+{
+    /**
+     * @brief 程序启动以来的堆分配次数（所有线程）
+     */
+    size_t count();
+}
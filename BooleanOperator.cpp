@@ -4,13 +4,207 @@
  */
 
 #include "BooleanOperator.h"
+#include "AllocationCounter.h"
+#include "CutCache.h"
+#include "MeshHash.h"
+#include "CylinderCutKernel.h"
+#include <MRMesh/MRMeshCollidePrecise.h>
+#include <MRMesh/MRContoursCut.h>
+#include <MRMesh/MRBooleanOperation.h>
+#include <MRMesh/MRProgressCallback.h>
+#include <MRMesh/MRBitSetParallelFor.h>
+#include <MRMesh/MRRegionBoundary.h>
+#include <MRMesh/MRPartMapping.h>
+#include <MRMesh/MRBox.h>
+#include <MRMesh/MRMeshCollide.h>
+#include <MRMesh/MRMeshPart.h>
+#include <MRMesh/MRParallelFor.h>
+#include <iterator>
+#include <tbb/parallel_invoke.h>
 #include <chrono>
 #include <iomanip>
+#include <sstream>
+
+const char* const BooleanOperator::kCanceledMsg = "Operation was canceled";
+
+namespace
+{
+    // 刀具顶点坐标的量化步长 (mm)，用于切割缓存的键
+    constexpr float kCutterQuantum = 1e-4f;
+    
+    /**
+     * @brief 从 origin 沿坐标轴 axis 正向的射线是否穿过三角形
+     * 
+     * 在垂直于射线的平面上用边函数判断投影是否包含射线。相邻三角形对公共边的
+     * 边函数值互为相反数，因此交点个数的奇偶不会因舍入而出错
+     * 
+     * @return 1 穿过，0 不穿过，-1 射线擦过边、顶点或起点落在三角形上（无法可靠计数）
+     */
+    int rayHitsTriangle(const MR::Vector3f& origin, int axis,
+                        const MR::Vector3f& a, const MR::Vector3f& b, const MR::Vector3f& c)
+    {
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+        auto edge = [&](const MR::Vector3f& p, const MR::Vector3f& q)
+        {
+            return (double(p[u]) - origin[u]) * (double(q[v]) - origin[v]) -
+                   (double(p[v]) - origin[v]) * (double(q[u]) - origin[u]);
+        };
+        const double eab = edge(a, b);
+        const double ebc = edge(b, c);
+        const double eca = edge(c, a);
+        const bool negative = eab < 0.0 || ebc < 0.0 || eca < 0.0;
+        const bool positive = eab > 0.0 || ebc > 0.0 || eca > 0.0;
+        if (negative && positive)
+        {
+            return 0;
+        }
+        
+        // 投影退化为线段：射线不在该直线上时不相交
+        const double area = eab + ebc + eca;
+        if (area == 0.0)
+        {
+            return negative || positive ? 0 : -1;
+        }
+        if (eab == 0.0 || ebc == 0.0 || eca == 0.0)
+        {
+            return -1;
+        }
+        
+        // 交点沿射线方向的坐标（重心坐标插值）
+        const double t = (ebc * a[axis] + eca * b[axis] + eab * c[axis]) / area;
+        if (t == origin[axis])
+        {
+            return -1;
+        }
+        return t > origin[axis] ? 1 : 0;
+    }
+    
+    /**
+     * @brief 作用域内的耗时和分配次数累加到一个阶段
+     */
+    class StageTimer
+    {
+    public:
+        explicit StageTimer(StageProfile& stage)
+            : stage_(stage)
+            , start_(std::chrono::high_resolution_clock::now())
+            , allocations_(AllocationCounter::count())
+        {
+        }
+        
+        ~StageTimer() { stop(); }
+        
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+        
+        void stop()
+        {
+            if (stopped_)
+            {
+                return;
+            }
+            stopped_ = true;
+            std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::high_resolution_clock::now() - start_;
+            stage_.ms += static_cast<float>(elapsed.count());
+            stage_.allocations += AllocationCounter::count() - allocations_;
+        }
+    
+    private:
+        StageProfile& stage_;
+        std::chrono::high_resolution_clock::time_point start_;
+        size_t allocations_ = 0;
+        bool stopped_ = false;
+    };
+}
+
+StageProfile& StageProfile::operator+=(const StageProfile& other)
+{
+    ms += other.ms;
+    allocations += other.allocations;
+    return *this;
+}
+
+BooleanProfile& BooleanProfile::operator+=(const BooleanProfile& other)
+{
+    classify += other.classify;
+    window += other.window;
+    tree += other.tree;
+    intersect += other.intersect;
+    contourCut += other.contourCut;
+    assembly += other.assembly;
+    boolean += other.boolean;
+    stitch += other.stitch;
+    copy += other.copy;
+    mass += other.mass;
+    kernel += other.kernel;
+    compact += other.compact;
+    numIntersections += other.numIntersections;
+    numContours += other.numContours;
+    cacheAccesses += other.cacheAccesses;
+    cacheMissesBefore += other.cacheMissesBefore;
+    cacheMissesAfter += other.cacheMissesAfter;
+    return *this;
+}
+
+std::string BooleanProfile::toString() const
+{
+    const std::pair<const char*, const StageProfile*> stages[] = {
+        {"Classify", &classify},
+        {"Window", &window},
+        {"AABB tree", &tree},
+        {"Intersect", &intersect},
+        {"Contour cut", &contourCut},
+        {"Assembly", &assembly},
+        {"MR::boolean", &boolean},
+        {"Stitch", &stitch},
+        {"Copy", &copy},
+        {"Mass props", &mass},
+        {"Cyl kernel", &kernel},
+        {"Compact", &compact},
+    };
+    
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    for (const auto& [name, stage] : stages)
+    {
+        if (stage->ms == 0.0f && stage->allocations == 0)
+        {
+            continue;
+        }
+        out << std::left << std::setw(12) << name << std::right
+            << std::setw(10) << stage->ms << " ms"
+            << std::setw(10) << stage->allocations << " allocs\n";
+    }
+    out << "Intersections: " << numIntersections << ", contours: " << numContours;
+    if (cacheAccesses > 0)
+    {
+        out << "\nCache misses (simulated): " << cacheMissesBefore << " -> " << cacheMissesAfter
+            << " of " << cacheAccesses << " accesses ("
+            << 100.0 * cacheMissesBefore / cacheAccesses << "% -> "
+            << 100.0 * cacheMissesAfter / cacheAccesses << "%)";
+    }
+    return out.str();
+}
 
 BooleanOperator::BooleanOperator()
+    : cache_(std::make_unique<CutCache>())
 {
 }
 
+BooleanOperator::~BooleanOperator() = default;
+
+void BooleanOperator::setCylinderCutter(const MR::Mesh* mesh, const CylinderParams& params, float chordTolerance)
+{
+    cylinderMesh_ = mesh;
+    cylinderParams_ = params;
+    chordTolerance_ = chordTolerance;
+    
+    // 内核与通用布尔运算的结果三角化不同，缓存的结果不再对应当前的切割方式
+    cache_->clear();
+}
+
 MR::BooleanOperation BooleanOperator::convertType(BooleanType type) const
 {
     switch (type)
@@ -20,7 +214,7 @@ MR::BooleanOperation BooleanOperator::convertType(BooleanType type) const
         case BooleanType::Intersection:
             return MR::BooleanOperation::Intersection;
         case BooleanType::Difference:
-            return MR::BooleanOperation::Intersection;
+            return MR::BooleanOperation::DifferenceAB;
         default:
             return MR::BooleanOperation::Union;
     }
@@ -43,7 +237,9 @@ std::string BooleanOperator::typeToString(BooleanType type)
 
 BooleanResult BooleanOperator::execute(const MR::Mesh& meshA, 
                                         const MR::Mesh& meshB, 
-                                        BooleanType type)
+                                        BooleanType type,
+                                        const MR::ProgressCallback& cb,
+                                        const MR::AffineXf3f* rigidB2A)
 {
     BooleanResult result;
     
@@ -64,12 +260,12 @@ BooleanResult BooleanOperator::execute(const MR::Mesh& meshA,
     auto start = std::chrono::high_resolution_clock::now();
     
     // 执行布尔运算
-    MR::BooleanResult mrResult = MR::boolean(meshA, meshB, convertType(type));
-    
-    // 记录结束时间
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double, std::milli> elapsed = end - start;
-    result.durationMs = static_cast<float>(elapsed.count());
+    MR::BooleanParameters params;
+    params.cb = cb;
+    params.rigidB2A = rigidB2A;
+    StageTimer booleanTimer(result.profile.boolean);
+    MR::BooleanResult mrResult = MR::boolean(meshA, meshB, convertType(type), params);
+    booleanTimer.stop();
     
     // 检查运算结果
     if (!mrResult.valid())
@@ -78,8 +274,16 @@ BooleanResult BooleanOperator::execute(const MR::Mesh& meshA,
         return result;
     }
     
-    // 提取结果网格
-    result.mesh = *mrResult;
+    // 提取结果网格（移动而非复制）
+    {
+        StageTimer copyTimer(result.profile.copy);
+        result.mesh = std::move(mrResult.mesh);
+    }
+    
+    // 记录结束时间
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    result.durationMs = static_cast<float>(elapsed.count());
     result.success = true;
     
     return result;
@@ -104,8 +308,868 @@ BooleanResult BooleanOperator::getCutPiece(const MR::Mesh& meshA, const MR::Mesh
         return result;
     }
     
-    result.mesh = *mrResult;
+    result.mesh = std::move(mrResult.mesh);
+    result.success = true;
+    
+    return result;
+}
+
+BooleanResult BooleanOperator::cut(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                   const MR::ProgressCallback& cb,
+                                   const MR::AffineXf3f* rigidB2A)
+{
+    return cutImpl(meshA, meshB, nullptr, cb, rigidB2A);
+}
+
+BooleanResult BooleanOperator::cut(const PreparedTarget& target, const MR::Mesh& meshB,
+                                   const MR::ProgressCallback& cb,
+                                   const MR::AffineXf3f* rigidB2A)
+{
+    const auto& meshA = target.getMesh();
+    if (!meshA)
+    {
+        BooleanResult result;
+        result.errorMsg = "Mesh A is empty";
+        return result;
+    }
+    
+    return cutImpl(*meshA, meshB, &target, cb, rigidB2A);
+}
+
+BooleanResult BooleanOperator::cutImpl(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                       const PreparedTarget* prepared, const MR::ProgressCallback& cb,
+                                       const MR::AffineXf3f* rigidB2A)
+{
+    // 缓存键：目标内容哈希（有空间索引时增量维护）和量化后的刀具几何
+    CutCache::Key key;
+    const bool useCache = cacheEnabled_ && !meshA.points.empty() && !meshB.points.empty();
+    if (useCache)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        key.target = prepared && prepared->getMesh().get() == &meshA ?
+                     prepared->contentHash() : MeshHash::meshHash(meshA);
+        key.cutter = MeshHash::cutterHash(meshB, rigidB2A, kCutterQuantum);
+        
+        if (auto cached = cache_->find(key))
+        {
+            // 命中时网格与缓存共享，只复制面集合等小字段
+            BooleanResult result = *cached;
+            result.cacheHit = true;
+            result.profile = BooleanProfile();
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> elapsed = end - start;
+            result.durationMs = static_cast<float>(elapsed.count());
+            result.profile.copy.ms = result.durationMs;
+            MR::reportProgress(cb, 1.0f);
+            return result;
+        }
+    }
+    
+    auto storeInCache = [&](const BooleanResult& result)
+    {
+        if (useCache && result.success)
+        {
+            cache_->insert(key, std::make_shared<const BooleanResult>(result));
+        }
+    };
+    
+    BooleanProfile classifyProfile;
+    if (auto trivial = cutTrivial(meshA, meshB, prepared, rigidB2A, &classifyProfile))
+    {
+        storeInCache(*trivial);
+        return std::move(*trivial);
+    }
+    
+    std::optional<BooleanResult> result;
+    if (windowParams_.enabled)
+    {
+        result = cutWindowed(meshA, meshB, prepared, cb, rigidB2A);
+    }
+    if (!result)
+    {
+        result = cutFull(meshA, meshB, nullptr, cb, rigidB2A);
+    }
+    
+    // 分类阶段没有得到结果，其耗时计入总耗时
+    result->profile += classifyProfile;
+    result->durationMs += classifyProfile.classify.ms;
+    storeInCache(*result);
+    return std::move(*result);
+}
+
+CutterPlacement BooleanOperator::classify(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                          const PreparedTarget* prepared,
+                                          const MR::AffineXf3f* rigidB2A) const
+{
+    // 有空间索引时使用目标句柄按版本缓存的包围盒
+    const bool indexed = prepared && prepared->getMesh().get() == &meshA;
+    const MR::Box3f boxA = indexed ? prepared->getMesh().boundingBox() : meshA.computeBoundingBox();
+    const MR::Box3f boxB = meshB.computeBoundingBox(rigidB2A);
+    if (!boxA.intersects(boxB))
+    {
+        return CutterPlacement::Outside;
+    }
+    
+    // 找到第一对相交三角形即可确定需要完整运算。只检测刀具包围盒内的面，
+    // 提取为子网格后求交，只为子网格构建 AABB 树，不构建目标网格的整棵树
+    const MR::FaceBitSet nearFaces = findFacesInBox(meshA, boxB, prepared);
+    if (nearFaces.any())
+    {
+        MR::Mesh nearMesh;
+        nearMesh.addPartByMask(meshA, nearFaces);
+        if (!MR::findCollidingTriangles(nearMesh, meshB, rigidB2A, true).empty())
+        {
+            return CutterPlacement::Crossing;
+        }
+    }
+    
+    // 表面不相交：刀具整体在目标内部或外部，用刀具上一点的射线奇偶测试区分；
+    // 射线擦过边或顶点无法判定时交给完整运算
+    const MR::VertId vB = meshB.topology.getValidVerts().find_first();
+    const MR::Vector3f pointB = rigidB2A ? (*rigidB2A)(meshB.points[vB]) : meshB.points[vB];
+    const std::optional<bool> cutterInside = containsPoint(meshA, boxA, pointB, prepared);
+    if (!cutterInside)
+    {
+        return CutterPlacement::Crossing;
+    }
+    if (*cutterInside)
+    {
+        return CutterPlacement::Inside;
+    }
+    
+    // 刀具包围盒包含整个目标时，目标的面都已在上面检测过，只需判断目标上一点是否在刀具内
+    if (boxB.contains(boxA.min) && boxB.contains(boxA.max))
+    {
+        const MR::VertId vA = meshA.topology.getValidVerts().find_first();
+        const MR::Vector3f pointA = rigidB2A ? rigidB2A->inverse()(meshA.points[vA]) : meshA.points[vA];
+        const std::optional<bool> targetInside = containsPoint(meshB, meshB.computeBoundingBox(), pointA, nullptr);
+        if (!targetInside)
+        {
+            return CutterPlacement::Crossing;
+        }
+        if (*targetInside)
+        {
+            return CutterPlacement::Enclosing;
+        }
+    }
+    return CutterPlacement::InRemoved;
+}
+
+MR::FaceBitSet BooleanOperator::findFacesInBox(const MR::Mesh& mesh, const MR::Box3f& box,
+                                               const PreparedTarget* prepared) const
+{
+    if (prepared && prepared->getMesh().get() == &mesh)
+    {
+        // 使用持久化的空间索引，只访问与 box 相交的单元
+        return prepared->findFacesInBox(box);
+    }
+    
+    const MR::FaceBitSet& validFaces = mesh.topology.getValidFaces();
+    MR::FaceBitSet faces(validFaces.size());
+    MR::BitSetParallelFor(validFaces, [&](MR::FaceId f)
+    {
+        MR::Vector3f v0, v1, v2;
+        mesh.getTriPoints(f, v0, v1, v2);
+        MR::Box3f triBox;
+        triBox.include(v0);
+        triBox.include(v1);
+        triBox.include(v2);
+        if (box.intersects(triBox))
+        {
+            faces.set(f);
+        }
+    });
+    
+    return faces;
+}
+
+std::optional<bool> BooleanOperator::containsPoint(const MR::Mesh& mesh, const MR::Box3f& meshBox,
+                                                   const MR::Vector3f& point,
+                                                   const PreparedTarget* prepared) const
+{
+    if (!meshBox.contains(point))
+    {
+        return false;
+    }
+    
+    // 依次尝试三个坐标轴方向，射线擦过边或顶点时换一个方向
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        MR::Box3f rayBox(point, point);
+        rayBox.max[axis] = meshBox.max[axis];
+        
+        int crossings = 0;
+        bool ambiguous = false;
+        for (MR::FaceId f : findFacesInBox(mesh, rayBox, prepared))
+        {
+            MR::Vector3f a, b, c;
+            mesh.getTriPoints(f, a, b, c);
+            const int hit = rayHitsTriangle(point, axis, a, b, c);
+            if (hit < 0)
+            {
+                ambiguous = true;
+                break;
+            }
+            crossings += hit;
+        }
+        if (!ambiguous)
+        {
+            return crossings % 2 == 1;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<BooleanResult> BooleanOperator::cutTrivial(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                                         const PreparedTarget* prepared,
+                                                         const MR::AffineXf3f* rigidB2A,
+                                                         BooleanProfile* profile) const
+{
+    if (meshA.points.empty() || meshB.points.empty())
+    {
+        return std::nullopt;
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    BooleanResult result;
+    StageTimer classifyTimer(result.profile.classify);
+    const CutterPlacement placement = classify(meshA, meshB, prepared, rigidB2A);
+    classifyTimer.stop();
+    if (placement == CutterPlacement::Crossing)
+    {
+        if (profile)
+        {
+            *profile += result.profile;
+        }
+        return std::nullopt;
+    }
+    
+    result.placement = placement;
+    result.success = true;
+    
+    switch (placement)
+    {
+        case CutterPlacement::Inside:
+        {
+            // 切出封闭空腔：目标加上反向的刀具外壳，碎片就是刀具本身
+            StageTimer copyTimer(result.profile.copy);
+            MR::Mesh shell = meshB;
+            if (rigidB2A)
+            {
+                shell.transform(*rigidB2A);
+            }
+            result.cutPiece = MR::Mesh(shell);
+            shell.topology.flipOrientation();
+            MR::Mesh& cavity = result.mesh.edit();
+            cavity = meshA;
+            const int oldFaceSize = static_cast<int>(cavity.topology.faceSize());
+            cavity.addMesh(shell);
+            copyTimer.stop();
+            
+            // 目标原有的面保持编号，空间索引只需插入外壳的面
+            result.cavity = true;
+            result.removedFaces.resize(oldFaceSize);
+            result.addedFaces.resize(cavity.topology.faceSize());
+            for (int f = oldFaceSize; f < static_cast<int>(cavity.topology.faceSize()); ++f)
+            {
+                result.addedFaces.set(MR::FaceId(f));
+            }
+            StageTimer massTimer(result.profile.mass);
+            result.massDelta = MassProperties::compute(cavity, &result.addedFaces);
+            break;
+        }
+        case CutterPlacement::Enclosing:
+        {
+            // 整个目标被切除
+            StageTimer copyTimer(result.profile.copy);
+            result.cutPiece = MR::Mesh(meshA);
+            copyTimer.stop();
+            StageTimer massTimer(result.profile.mass);
+            result.massDelta -= MassProperties::compute(meshA);
+            break;
+        }
+        default:
+            // 刀具不接触材料，目标保持不变，无需复制
+            result.unchanged = true;
+            break;
+    }
+    result.hasMassDelta = true;
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    result.durationMs = static_cast<float>(elapsed.count());
+    
+    return result;
+}
+
+BooleanResult BooleanOperator::cutFull(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                       MR::BooleanResultMapper* mapper,
+                                       const MR::ProgressCallback& cb,
+                                       const MR::AffineXf3f* rigidB2A)
+{
+    BooleanResult result;
+    
+    // 检查输入网格是否有效
+    if (meshA.points.empty())
+    {
+        result.errorMsg = "Mesh A is empty";
+        return result;
+    }
+    
+    if (meshB.points.empty())
+    {
+        result.errorMsg = "Mesh B is empty";
+        return result;
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    // 各阶段之间汇报进度，回调返回 false 时中止
+    auto canceled = [&](float progress)
+    {
+        if (MR::reportProgress(cb, progress))
+        {
+            return false;
+        }
+        result.errorMsg = kCanceledMsg;
+        return true;
+    };
+    
+    if (canceled(0.0f))
+    {
+        return result;
+    }
+    
+    // 圆柱刀具先尝试解析内核：与隐式圆柱面求交，不需要 AABB 树和精确求交
+    if (cylinderMesh_ == &meshB)
+    {
+        StageTimer kernelTimer(result.profile.kernel);
+        std::optional<BooleanResult> drilled = CylinderCutKernel::cut(
+            meshA, cylinderParams_, rigidB2A ? *rigidB2A : MR::AffineXf3f(), chordTolerance_);
+        kernelTimer.stop();
+        if (drilled)
+        {
+            drilled->profile += result.profile;
+            
+            // 内核保留 A 的全部顶点编号
+            if (mapper)
+            {
+                MR::VertMap& old2new = mapper->maps[int(MR::BooleanResultMapper::MapObject::A)].old2newVerts;
+                old2new.resize(meshA.points.size());
+                for (MR::VertId v(0); v < old2new.size(); ++v)
+                {
+                    old2new[v] = v;
+                }
+            }
+            
+            StageTimer massTimer(drilled->profile.mass);
+            // 只对内核删除和新增的面求和，与窗口模式相同
+            drilled->massDelta = MassProperties::compute(*drilled->mesh, &drilled->addedFaces) -
+                                 MassProperties::compute(meshA, &drilled->removedFaces);
+            drilled->hasMassDelta = true;
+            massTimer.stop();
+            MR::reportProgress(cb, 1.0f);
+            
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> elapsed = end - start;
+            drilled->durationMs = static_cast<float>(elapsed.count());
+            return std::move(*drilled);
+        }
+    }
+    
+    // 0. AABB 树（求交时按需构建，单独计时以区分构建与查询）。
+    //    空间索引只为加载时的网格预热过目标的树，切割后的网格在这里整体重建
+    //    （除非可视化器的后台任务已经建好）
+    {
+        StageTimer treeTimer(result.profile.tree);
+        tbb::parallel_invoke(
+            [&]() { meshA.getAABBTree(); },
+            [&]() { meshB.getAABBTree(); });
+    }
+    
+    // 1. 求交（只做一次）
+    StageTimer intersectTimer(result.profile.intersect);
+    auto converters = MR::getVectorConverters(meshA, meshB, rigidB2A);
+    auto intersections = MR::findCollidingEdgeTrisPrecise(meshA, meshB, converters.toInt, rigidB2A);
+    result.contours = MR::orderIntersectionContours(meshA.topology, meshB.topology, intersections);
+    intersectTimer.stop();
+    result.profile.numIntersections = intersections.edgesAtrisB.size() + intersections.edgesBtrisA.size();
+    result.profile.numContours = result.contours.size();
+    
+    if (canceled(0.4f))
+    {
+        return result;
+    }
+    
+    if (result.contours.empty())
+    {
+        // 没有交线：刀具在模型外、已切除区域内或完全包含关系
+        if (auto trivial = cutTrivial(meshA, meshB, nullptr, rigidB2A))
+        {
+            trivial->profile += result.profile;
+            return std::move(*trivial);
+        }
+        
+        // 浮点检测与精确求交结论不一致时，交给 MR::boolean 处理
+        BooleanResult diff = execute(meshA, meshB, BooleanType::Difference, MR::subprogress(cb, 0.4f, 0.7f), rigidB2A);
+        diff.profile += result.profile;
+        if (!diff.success)
+        {
+            return diff;
+        }
+        MR::BooleanParameters pieceParams;
+        pieceParams.cb = MR::subprogress(cb, 0.7f, 1.0f);
+        pieceParams.rigidB2A = rigidB2A;
+        StageTimer pieceTimer(diff.profile.boolean);
+        MR::BooleanResult pieceResult = MR::boolean(meshA, meshB, MR::BooleanOperation::Intersection, pieceParams);
+        pieceTimer.stop();
+        if (pieceResult.valid())
+        {
+            diff.cutPiece = std::move(pieceResult.mesh);
+        }
+        StageTimer massTimer(diff.profile.mass);
+        diff.massDelta = MassProperties::compute(*diff.mesh) - MassProperties::compute(meshA);
+        diff.hasMassDelta = true;
+        massTimer.stop();
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+        diff.durationMs = static_cast<float>(elapsed.count());
+        return diff;
+    }
+    
+    // 2. 沿交线切开两个网格（只做一次）
+    StageTimer copyTimer(result.profile.copy);
+    MR::Mesh cutA = meshA;
+    MR::Mesh cutB = meshB;
+    copyTimer.stop();
+    
+    StageTimer contourCutTimer(result.profile.contourCut);
+    MR::OneMeshContours contoursA, contoursB;
+    MR::getOneMeshIntersectionContours(meshA, meshB, result.contours, &contoursA, &contoursB, converters, rigidB2A);
+    MR::CutMeshResult cutResA = MR::cutMesh(cutA, contoursA);
+    MR::CutMeshResult cutResB = MR::cutMesh(cutB, contoursB);
+    contourCutTimer.stop();
+    
+    if (canceled(0.7f))
+    {
+        return result;
+    }
+    
+    if (cutResA.fbsWithCountourIntersections.any() || cutResB.fbsWithCountourIntersections.any())
+    {
+        result.errorMsg = "Intersection contours have self-intersections";
+        return result;
+    }
+    
+    // 3. 在同一份切开的网格上分别组装差集和碎片（差集消耗一份副本）
+    StageTimer diffCopyTimer(result.profile.copy);
+    MR::Mesh diffA = cutA;
+    MR::Mesh diffB = cutB;
+    diffCopyTimer.stop();
+    
+    StageTimer assemblyTimer(result.profile.assembly);
+    auto diffMesh = MR::doBooleanOperation(std::move(diffA), std::move(diffB),
+                                           cutResA.resultCut, cutResB.resultCut,
+                                           MR::BooleanOperation::DifferenceAB, rigidB2A, mapper);
+    assemblyTimer.stop();
+    if (canceled(0.85f))
+    {
+        return result;
+    }
+    StageTimer pieceTimer(result.profile.assembly);
+    auto pieceMesh = MR::doBooleanOperation(std::move(cutA), std::move(cutB),
+                                            cutResA.resultCut, cutResB.resultCut,
+                                            MR::BooleanOperation::Intersection, rigidB2A);
+    pieceTimer.stop();
+    
+    if (!diffMesh.has_value())
+    {
+        result.errorMsg = diffMesh.error();
+        return result;
+    }
+    
+    result.mesh = std::move(*diffMesh);
+    if (pieceMesh.has_value())
+    {
+        result.cutPiece = std::move(*pieceMesh);
+    }
+    
+    // 全局运算的结果没有改动区域信息，只能整体求和
+    StageTimer massTimer(result.profile.mass);
+    result.massDelta = MassProperties::compute(*result.mesh) - MassProperties::compute(meshA);
+    result.hasMassDelta = true;
+    massTimer.stop();
+    result.success = true;
+    MR::reportProgress(cb, 1.0f);
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    result.durationMs = static_cast<float>(elapsed.count());
+    
+    return result;
+}
+
+std::optional<BooleanResult> BooleanOperator::cutWindowed(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                                          const PreparedTarget* prepared,
+                                                          const MR::ProgressCallback& cb,
+                                                          const MR::AffineXf3f* rigidB2A)
+{
+    if (meshA.points.empty() || meshB.points.empty())
+    {
+        return std::nullopt;
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    // 1. 选出窗口内的面
+    StageProfile selectStage;
+    StageTimer selectTimer(selectStage);
+    MR::FaceBitSet windowFaces = selectWindowFaces(meshA, meshB.computeBoundingBox(rigidB2A), prepared);
+    selectTimer.stop();
+    
+    const size_t numWindowFaces = windowFaces.count();
+    if (numWindowFaces == 0 ||
+        numWindowFaces > windowParams_.maxFaceRatio * meshA.topology.numValidFaces())
+    {
+        return std::nullopt;
+    }
+    
+    // 2. 只在窗口子网格上切割
+    std::vector<WindowPatch> patches;
+    if (auto patch = cutWindow(meshA, meshB, std::move(windowFaces), MR::subprogress(cb, 0.0f, 0.9f), rigidB2A))
+    {
+        patches.push_back(std::move(*patch));
+    }
+    else
+    {
+        return std::nullopt;
+    }
+    
+    // 3. 缝回原网格：有空间索引时共享其句柄，没有其他持有者时就地缝合
+    MeshHandle target = prepared && prepared->getMesh().get() == &meshA ?
+                        prepared->getMesh() : MeshHandle(MR::Mesh(meshA));
+    BooleanResult result = stitchWindows(std::move(target), patches);
+    result.profile.window += selectStage;
+    MR::reportProgress(cb, 1.0f);
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    result.durationMs = static_cast<float>(elapsed.count());
+    
+    return result;
+}
+
+MR::FaceBitSet BooleanOperator::selectWindowFaces(const MR::Mesh& meshA, const MR::Box3f& cutterBox,
+                                                  const PreparedTarget* prepared) const
+{
+    // 选出三角形包围盒与（刀具包围盒 + 余量）相交的面
+    // 窗口边界上的边属于某个窗口外的面，因此离刀具至少 margin 远，
+    // 切割不会碰到窗口边界
+    const MR::Box3f window = cutterBox.expanded(MR::Vector3f::diagonal(windowParams_.margin));
+    return findFacesInBox(meshA, window, prepared);
+}
+
+std::optional<WindowPatch> BooleanOperator::cutWindow(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                                      MR::FaceBitSet windowFaces,
+                                                      const MR::ProgressCallback& cb,
+                                                      const MR::AffineXf3f* rigidB2A)
+{
+    WindowPatch patch;
+    patch.windowFaces = std::move(windowFaces);
+    
+    // 提取窗口子网格，记录原网格到子网格的顶点映射
+    StageProfile windowStage;
+    StageTimer extractTimer(windowStage);
+    MR::VertMap target2subVerts;
+    MR::Mesh subMesh;
+    MR::PartMapping extractMap;
+    extractMap.src2tgtVerts = &target2subVerts;
+    subMesh.addPartByMask(meshA, patch.windowFaces, extractMap);
+    extractTimer.stop();
+    
+    // 只在子网格上切割
+    MR::BooleanResultMapper mapper;
+    patch.cut = cutFull(subMesh, meshB, &mapper, cb, rigidB2A);
+    if (!patch.cut.success || patch.cut.profile.numContours == 0)
+    {
+        // 刀具没有穿过窗口内的表面（完全在内部或外部），交给全局运算处理
+        // （解析内核不输出 contours，只记录交线环数）
+        return std::nullopt;
+    }
+    
+    StageTimer matchTimer(windowStage);
+    
+    // 找到补丁上与窗口边界环一一对应的边
+    const MR::Mesh& patchMesh = *patch.cut.mesh;
+    const MR::VertMap& sub2patchVerts =
+        mapper.maps[int(MR::BooleanResultMapper::MapObject::A)].old2newVerts;
+    
+    std::vector<MR::EdgeLoop> windowLoops = MR::findLeftBoundary(meshA.topology, patch.windowFaces);
+    patch.targetLoops.reserve(windowLoops.size());
+    patch.patchLoops.reserve(windowLoops.size());
+    
+    for (auto& loop : windowLoops)
+    {
+        MR::EdgePath patchPath;
+        patchPath.reserve(loop.size());
+        for (MR::EdgeId e : loop)
+        {
+            const MR::VertId o = sub2patchVerts.getAt(target2subVerts.getAt(meshA.topology.org(e)));
+            const MR::VertId d = sub2patchVerts.getAt(target2subVerts.getAt(meshA.topology.dest(e)));
+            const MR::EdgeId patchEdge = (o && d) ? patchMesh.topology.findEdge(o, d) : MR::EdgeId();
+            if (!patchEdge)
+            {
+                return std::nullopt;
+            }
+            patchPath.push_back(patchEdge);
+        }
+        patch.targetLoops.push_back(std::move(loop));
+        patch.patchLoops.push_back(std::move(patchPath));
+    }
+    
+    matchTimer.stop();
+    patch.cut.profile.window += windowStage;
+    return patch;
+}
+
+BooleanResult BooleanOperator::stitchWindows(MeshHandle target, std::vector<WindowPatch>& patches)
+{
+    BooleanResult result;
+    
+    MR::FaceBitSet allWindows(target->topology.faceSize());
+    for (const auto& patch : patches)
+    {
+        allWindows |= patch.windowFaces;
+        result.profile += patch.cut.profile;
+    }
+    
+    // 窗口外的面没有变化，质量特性的变化只来自窗口内删除和新增的面；
+    // 删除的部分在修改网格之前求和
+    StageTimer removedMassTimer(result.profile.mass);
+    const MassProperties removedMass = MassProperties::compute(*target, &allWindows);
+    removedMassTimer.stop();
+    
+    // 删除窗口内的面后，边界边左侧为空，正好与补丁边界对接。
+    // 网格仍被共享（主窗口、空间索引、历史）时 edit() 才复制
+    StageTimer copyTimer(result.profile.copy);
+    MR::Mesh& stitched = target.edit();
+    copyTimer.stop();
+    
+    StageTimer stitchTimer(result.profile.stitch);
+    stitched.deleteFaces(allWindows);
+    MR::Mesh cutPiece;
+    
+    for (auto& patch : patches)
+    {
+        const MR::Mesh& patchMesh = *patch.cut.mesh;
+        MR::FaceMap patch2stitchedFaces;
+        MR::PartMapping stitchMap;
+        stitchMap.src2tgtFaces = &patch2stitchedFaces;
+        stitched.addPartByMask(patchMesh, patchMesh.topology.getValidFaces(), false,
+                               patch.targetLoops, patch.patchLoops, stitchMap);
+        
+        // 记录新增的面，供空间索引增量更新
+        for (MR::FaceId f : patchMesh.topology.getValidFaces())
+        {
+            if (MR::FaceId newFace = patch2stitchedFaces.getAt(f))
+            {
+                result.addedFaces.autoResizeSet(newFace);
+            }
+        }
+        
+        // 合并碎片和交线
+        if (patch.cut.cutPiece)
+        {
+            cutPiece.addMesh(*patch.cut.cutPiece);
+        }
+        result.contours.insert(result.contours.end(),
+                               std::make_move_iterator(patch.cut.contours.begin()),
+                               std::make_move_iterator(patch.cut.contours.end()));
+    }
+    
+    stitchTimer.stop();
+    
+    result.addedFaces.resize(stitched.topology.faceSize());
+    result.removedFaces = std::move(allWindows);
+    result.windowed = true;
+    stitched.invalidateCaches();
+    result.mesh = std::move(target);
+    result.cutPiece = std::move(cutPiece);
+    
+    StageTimer massTimer(result.profile.mass);
+    result.massDelta = MassProperties::compute(*result.mesh, &result.addedFaces) - removedMass;
+    result.hasMassDelta = true;
+    massTimer.stop();
     result.success = true;
     
     return result;
 }
+
+BatchResult BooleanOperator::differenceMany(const MR::Mesh& target, std::span<const MR::Mesh> cutters)
+{
+    BatchResult batch;
+    batch.numCutters = static_cast<int>(cutters.size());
+    
+    auto elapsedMs = [](auto from, auto to)
+    {
+        std::chrono::duration<double, std::milli> elapsed = to - from;
+        return static_cast<float>(elapsed.count());
+    };
+    
+    // 1. 剔除空网格、重复刀具以及被其他刀具完全包含的刀具
+    auto filterStart = std::chrono::high_resolution_clock::now();
+    
+    std::vector<MR::Box3f> boxes(cutters.size());
+    for (size_t i = 0; i < cutters.size(); ++i)
+    {
+        boxes[i] = cutters[i].computeBoundingBox();
+    }
+    
+    auto isDuplicate = [&](size_t i, size_t j)
+    {
+        return boxes[i] == boxes[j] && cutters[i].points == cutters[j].points;
+    };
+    
+    // 不接触材料的刀具（钻孔批次中很常见）不参与运算
+    std::vector<char> noOp(cutters.size(), 0);
+    MR::ParallelFor(size_t(0), cutters.size(), [&](size_t i)
+    {
+        if (!cutters[i].points.empty() && !target.points.empty())
+        {
+            const CutterPlacement placement = classify(target, cutters[i]);
+            noOp[i] = placement == CutterPlacement::Outside || placement == CutterPlacement::InRemoved;
+        }
+    });
+    
+    std::vector<size_t> kept;
+    kept.reserve(cutters.size());
+    size_t numNoOp = 0;
+    for (size_t i = 0; i < cutters.size(); ++i)
+    {
+        if (cutters[i].points.empty())
+        {
+            continue;
+        }
+        if (noOp[i])
+        {
+            ++numNoOp;
+            continue;
+        }
+        
+        bool skip = false;
+        for (size_t j = 0; j < cutters.size() && !skip; ++j)
+        {
+            if (i == j || cutters[j].points.empty() || noOp[j] ||
+                !boxes[j].contains(boxes[i].min) || !boxes[j].contains(boxes[i].max))
+            {
+                continue;
+            }
+            if (isDuplicate(i, j))
+            {
+                // 重复刀具只保留第一个
+                skip = j < i;
+            }
+            else if (MR::isInside(cutters[i], cutters[j]))
+            {
+                // 几何相同但顶点不同的刀具（如接缝位置不同的圆柱）互相包含，同样只保留第一个
+                skip = j < i || !MR::isInside(cutters[j], cutters[i]);
+            }
+        }
+        
+        if (!skip)
+        {
+            kept.push_back(i);
+        }
+    }
+    
+    batch.numSkipped = batch.numCutters - static_cast<int>(kept.size());
+    auto filterEnd = std::chrono::high_resolution_clock::now();
+    batch.filterMs = elapsedMs(filterStart, filterEnd);
+    
+    if (kept.empty())
+    {
+        if (numNoOp > 0)
+        {
+            // 所有刀具都不接触材料
+            batch.boolean.placement = CutterPlacement::InRemoved;
+            batch.boolean.unchanged = true;
+            batch.boolean.success = true;
+        }
+        else
+        {
+            batch.boolean.errorMsg = "No valid cutter";
+        }
+        return batch;
+    }
+    
+    // 2. 并行归约树求刀具并集
+    BooleanResult unionResult = unionOf(cutters, kept);
+    auto unionEnd = std::chrono::high_resolution_clock::now();
+    batch.unionMs = elapsedMs(filterEnd, unionEnd);
+    
+    if (!unionResult.success)
+    {
+        batch.boolean = std::move(unionResult);
+        return batch;
+    }
+    
+    // 3. 只做一次差集
+    batch.boolean = cut(target, *unionResult.mesh);
+    auto subtractEnd = std::chrono::high_resolution_clock::now();
+    batch.subtractMs = elapsedMs(unionEnd, subtractEnd);
+    batch.boolean.durationMs = elapsedMs(filterStart, subtractEnd);
+    
+    return batch;
+}
+
+BooleanResult BooleanOperator::unionOf(std::span<const MR::Mesh> cutters,
+                                       const std::vector<size_t>& indices)
+{
+    if (indices.empty())
+    {
+        BooleanResult result;
+        result.errorMsg = "No valid cutter";
+        return result;
+    }
+    
+    return unionRange(cutters, indices, 0, indices.size());
+}
+
+BooleanResult BooleanOperator::unionRange(std::span<const MR::Mesh> cutters,
+                                          const std::vector<size_t>& indices,
+                                          size_t begin, size_t end)
+{
+    if (end - begin == 1)
+    {
+        BooleanResult leaf;
+        leaf.mesh = MR::Mesh(cutters[indices[begin]]);
+        leaf.success = true;
+        return leaf;
+    }
+    
+    // 左右两半并行求并集
+    const size_t mid = begin + (end - begin) / 2;
+    BooleanResult left, right;
+    tbb::parallel_invoke(
+        [&]() { left = unionRange(cutters, indices, begin, mid); },
+        [&]() { right = unionRange(cutters, indices, mid, end); });
+    
+    if (!left.success)
+    {
+        return left;
+    }
+    if (!right.success)
+    {
+        return right;
+    }
+    
+    // 包围盒不相交的两组刀具直接合并，无需布尔运算
+    if (!left.mesh.boundingBox().intersects(right.mesh.boundingBox()))
+    {
+        left.mesh.edit().addMesh(*right.mesh);
+        return left;
+    }
+    
+    return execute(*left.mesh, *right.mesh, BooleanType::Union);
+}
@@ -9,8 +9,20 @@
 
 #include <MRMesh/MRMesh.h>
 #include <MRMesh/MRMeshBoolean.h>
+#include <MRMesh/MRIntersectionContour.h>
+#include <MRMesh/MRProgressCallback.h>
+#include <MRMesh/MRAffineXf3.h>
+#include "PreparedTarget.h"
+#include "MassProperties.h"
+#include "CylinderGenerator.h"
+#include "MeshHandle.h"
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
+
+class CutCache;
 
 /**
  * @brief 布尔运算类型
@@ -22,15 +34,125 @@ enum class BooleanType
     Difference,     ///< 差集 (A - B)
 };
 
+/**
+ * @brief 刀具相对目标网格的位置关系
+ */
+enum class CutterPlacement
+{
+    Crossing,       ///< 刀具穿过目标表面，需要完整的布尔运算
+    Outside,        ///< 包围盒不相交，刀具在目标外部
+    InRemoved,      ///< 刀具位于已切除的区域（或模型凹处）内，不接触材料
+    Inside,         ///< 刀具完全在目标内部，切出封闭空腔
+    Enclosing,      ///< 刀具完全包含目标
+};
+
+/**
+ * @brief 单个阶段的耗时和堆分配次数
+ */
+struct StageProfile
+{
+    float ms = 0.0f;            ///< 耗时（毫秒）
+    size_t allocations = 0;     ///< 堆分配次数（见 AllocationCounter）
+    
+    StageProfile& operator+=(const StageProfile& other);
+};
+
+/**
+ * @brief 布尔运算各阶段的剖析数据
+ */
+struct BooleanProfile
+{
+    StageProfile classify;      ///< 位置分类（包围盒、首个相交三角形、点包含测试）
+    StageProfile window;        ///< 窗口选面、子网格提取和边界对应
+    StageProfile tree;          ///< AABB 树构建
+    StageProfile intersect;     ///< 求交并排序交线轮廓
+    StageProfile contourCut;    ///< 沿交线切开网格
+    StageProfile assembly;      ///< 拓扑组装（差集和碎片）
+    StageProfile boolean;       ///< 整体调用 MR::boolean（无法细分的路径）
+    StageProfile stitch;        ///< 补丁缝回目标网格
+    StageProfile copy;          ///< 网格复制
+    StageProfile mass;          ///< 质量特性
+    StageProfile kernel;        ///< 解析圆柱内核（钻孔）
+    StageProfile compact;       ///< 压缩编号并按空间填充曲线重排
+    size_t numIntersections = 0;  ///< 相交的边-三角形对数
+    size_t numContours = 0;       ///< 交线轮廓数
+    size_t cacheAccesses = 0;     ///< 重排前后各模拟的内存访问次数（见 MeshLayout::measureLocality）
+    size_t cacheMissesBefore = 0; ///< 重排前的模拟缓存缺失次数
+    size_t cacheMissesAfter = 0;  ///< 重排后的模拟缓存缺失次数
+    
+    BooleanProfile& operator+=(const BooleanProfile& other);
+    
+    /**
+     * @brief 多行文本，每个非空阶段一行
+     */
+    std::string toString() const;
+};
+
 /**
  * @brief 布尔运算结果
  */
 struct BooleanResult
 {
-    MR::Mesh mesh;           ///< 结果网格
+    MeshHandle mesh;         ///< 结果网格（与缓存、调用方共享，不复制）
     bool success = false;    ///< 是否成功
     std::string errorMsg;    ///< 错误信息（如果失败）
     float durationMs = 0.0f; ///< 运算耗时（毫秒）
+    BooleanProfile profile;  ///< 各阶段耗时和分配次数
+    
+    // 以下字段仅由 cut() 填充
+    CutterPlacement placement = CutterPlacement::Crossing;  ///< 刀具位置分类
+    bool cacheHit = false;            ///< 是否直接取自切割缓存
+    bool unchanged = false;           ///< 目标未被改变（mesh 为空，调用方保留原网格）
+    MassProperties massDelta;         ///< 目标质量特性的变化（结果 - 目标），只对改动的面求和
+    bool hasMassDelta = false;        ///< massDelta 是否有效
+    MeshHandle cutPiece;              ///< 被切掉的碎片 (A ∩ B)
+    MR::ContinuousContours contours;  ///< A 与 B 共享的交线轮廓
+    
+    // 以下字段由窗口模式填充，用于增量更新空间索引；解析内核也填充面集合，只用于质量特性
+    bool windowed = false;            ///< 是否由窗口模式得到（未改动的面保持编号）
+    bool cavity = false;              ///< 刀具在目标内部切出空腔：目标的面保持编号，外壳的面追加在后
+    MR::FaceBitSet removedFaces;      ///< 从 A 中删除的面（A 的编号）
+    MR::FaceBitSet addedFaces;        ///< 结果中新增的面（结果的编号）
+};
+
+/**
+ * @brief 窗口切割得到的补丁
+ * 
+ * 记录窗口子网格上的切割结果，以及目标网格与补丁之间对应的边界环，
+ * 多个互不相邻的补丁可以一次性缝回目标网格
+ */
+struct WindowPatch
+{
+    BooleanResult cut;                       ///< 窗口子网格上的切割结果（mesh 为补丁）
+    MR::FaceBitSet windowFaces;              ///< 窗口内的面（目标网格编号）
+    std::vector<MR::EdgePath> targetLoops;   ///< 目标网格上的窗口边界环
+    std::vector<MR::EdgePath> patchLoops;    ///< 补丁上对应的边界环
+};
+
+/**
+ * @brief 批量切割结果
+ */
+struct BatchResult
+{
+    BooleanResult boolean;       ///< 目标减去所有刀具并集的结果
+    int numCutters = 0;          ///< 输入刀具数
+    int numSkipped = 0;          ///< 因不接触材料、重复或被其他刀具包含而跳过的刀具数
+    float filterMs = 0.0f;       ///< 去重/包含检测耗时（毫秒）
+    float unionMs = 0.0f;        ///< 刀具并集耗时（毫秒）
+    float subtractMs = 0.0f;     ///< 最终差集耗时（毫秒）
+};
+
+/**
+ * @brief 局部（窗口）布尔运算参数
+ * 
+ * 启用后 cut() 只把刀具包围盒（加余量）内的面交给布尔运算，
+ * 再沿窗口边界把结果缝回原网格
+ */
+struct WindowParams
+{
+    bool enabled = false;          ///< 是否启用窗口模式
+    float margin = 1.0f;           ///< 刀具包围盒向外扩展的余量 (mm)
+    float maxFaceRatio = 0.5f;     ///< 窗口面数超过该比例时退回全局布尔运算
 };
 
 /**
@@ -40,18 +162,22 @@ class BooleanOperator
 {
 public:
     BooleanOperator();
-    ~BooleanOperator() = default;
+    ~BooleanOperator();
     
     /**
      * @brief 执行布尔运算
      * @param meshA 第一个网格（被操作对象）
      * @param meshB 第二个网格（操作对象，如切割工具）
      * @param type 布尔运算类型
+     * @param cb 进度回调，返回 false 时中止运算
+     * @param rigidB2A 可选，meshB 到 meshA 空间的刚体变换
      * @return 运算结果
      */
     BooleanResult execute(const MR::Mesh& meshA, 
                           const MR::Mesh& meshB, 
-                          BooleanType type);
+                          BooleanType type,
+                          const MR::ProgressCallback& cb = {},
+                          const MR::AffineXf3f* rigidB2A = nullptr);
     
     /**
      * @brief 执行布尔差集运算 (A - B)
@@ -69,14 +195,198 @@ public:
      */
     BooleanResult getCutPiece(const MR::Mesh& meshA, const MR::Mesh& meshB);
     
+    /**
+     * @brief 单次切割：只求一次交线，同时得到剩余部分和切割碎片
+     * 
+     * 交线搜索和网格切开只做一次，然后在同一份切开的网格上
+     * 分别组装差集 (A - B) 和交集 (A ∩ B)
+     * 
+     * @param meshA 被切割网格
+     * @param meshB 切割工具网格
+     * @param cb 进度回调，返回 false 时中止运算
+     * @param rigidB2A 可选，刀具位姿（meshB 到 meshA 空间的刚体变换），
+     *        刀具网格本身保持在规范位置，不需要为每个位姿重新生成
+     * @return mesh 为剩余部分，cutPiece 为碎片，contours 为交线
+     */
+    BooleanResult cut(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                      const MR::ProgressCallback& cb = {},
+                      const MR::AffineXf3f* rigidB2A = nullptr);
+    
+    /**
+     * @brief 对预处理的目标网格执行单次切割
+     * 
+     * 窗口模式下使用目标的空间索引选取窗口内的面，无需遍历整个网格
+     * 
+     * @param target 预处理的目标网格（空间索引未完成时会等待）
+     * @param meshB 切割工具网格
+     * @param cb 进度回调，返回 false 时中止运算
+     * @param rigidB2A 可选，刀具位姿（meshB 到目标空间的刚体变换）
+     */
+    BooleanResult cut(const PreparedTarget& target, const MR::Mesh& meshB,
+                      const MR::ProgressCallback& cb = {},
+                      const MR::AffineXf3f* rigidB2A = nullptr);
+    
+    /**
+     * @brief 快速判断刀具与目标的位置关系
+     * 
+     * 依次使用包围盒、空间索引和首个相交三角形检测（只在刀具包围盒内的子网格上求交），
+     * 不相交时再用射线奇偶测试区分内部与外部，不构建目标网格的 AABB 树
+     * 
+     * @param prepared 可选，目标网格的空间索引
+     */
+    CutterPlacement classify(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                             const PreparedTarget* prepared = nullptr,
+                             const MR::AffineXf3f* rigidB2A = nullptr) const;
+    
+    /**
+     * @brief 批量切割：从目标中一次性减去多个刀具
+     * 
+     * 先剔除不接触材料、重复或被其他刀具完全包含的刀具，再用并行归约树求刀具并集，
+     * 最后只做一次差集运算
+     * 
+     * @param target 被切割网格
+     * @param cutters 切割工具网格列表
+     * @return 批量切割结果及各阶段耗时
+     */
+    BatchResult differenceMany(const MR::Mesh& target, std::span<const MR::Mesh> cutters);
+    
+    /**
+     * @brief 并行归约求 cutters[indices] 的并集
+     */
+    BooleanResult unionOf(std::span<const MR::Mesh> cutters, const std::vector<size_t>& indices);
+    
+    /**
+     * @brief 选出与（刀具包围盒 + 余量）相交的目标面
+     * @param prepared 可选，目标网格的空间索引
+     */
+    MR::FaceBitSet selectWindowFaces(const MR::Mesh& meshA, const MR::Box3f& cutterBox,
+                                     const PreparedTarget* prepared = nullptr) const;
+    
+    /**
+     * @brief 在给定窗口内切割，得到可缝回目标网格的补丁
+     * @return 刀具没有穿过窗口表面或边界无法对应时返回 std::nullopt
+     */
+    std::optional<WindowPatch> cutWindow(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                         MR::FaceBitSet windowFaces,
+                                         const MR::ProgressCallback& cb = {},
+                                         const MR::AffineXf3f* rigidB2A = nullptr);
+    
+    /**
+     * @brief 删除所有窗口内的面，并把补丁沿边界环缝回目标网格
+     * @param target 目标网格句柄，通过 edit() 修改：只有数据仍被其他持有者共享时才复制
+     * @param patches 互不相邻的窗口补丁（碎片和交线会被移出）
+     */
+    static BooleanResult stitchWindows(MeshHandle target, std::vector<WindowPatch>& patches);
+    
+    /**
+     * @brief 设置窗口模式参数
+     */
+    void setWindowParams(const WindowParams& params) { windowParams_ = params; }
+    
+    /**
+     * @brief 获取窗口模式参数
+     */
+    const WindowParams& getWindowParams() const { return windowParams_; }
+    
+    /**
+     * @brief 启用或禁用切割缓存（默认启用）
+     */
+    void setCacheEnabled(bool enabled) { cacheEnabled_ = enabled; }
+    
+    /**
+     * @brief 登记圆柱刀具网格，之后以它为刀具的切割先尝试解析圆柱内核
+     * 
+     * 内核直接与隐式圆柱面求交，只处理钻孔情形，其余情形仍由通用布尔运算处理
+     * 
+     * @param mesh 刀具网格（规范位置），按地址识别，调用方需保证其生命周期；nullptr 表示取消
+     * @param params 生成该网格的圆柱参数
+     * @param chordTolerance 孔壁弦高误差 (mm)
+     */
+    void setCylinderCutter(const MR::Mesh* mesh, const CylinderParams& params, float chordTolerance = 0.01f);
+    
+    /**
+     * @brief 切割缓存，用于查询命中统计、设置内存上限或清空
+     */
+    CutCache& getCache() { return *cache_; }
+    
     /**
      * @brief 将布尔类型转换为字符串
      */
     static std::string typeToString(BooleanType type);
     
+    /// 运算被进度回调中止时的错误信息
+    static const char* const kCanceledMsg;
+
 private:
     /**
      * @brief 将 BooleanType 转换为 MR::BooleanOperation
      */
     MR::BooleanOperation convertType(BooleanType type) const;
+    
+    /**
+     * @brief 单次切割的公共流程：分类、窗口切割、全局切割
+     */
+    BooleanResult cutImpl(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                          const PreparedTarget* prepared, const MR::ProgressCallback& cb,
+                          const MR::AffineXf3f* rigidB2A);
+    
+    /**
+     * @brief 刀具没有穿过目标表面时，无需求交线直接得到切割结果
+     * @param profile 可选输出，返回 std::nullopt 时记录分类阶段的耗时
+     * @return 刀具穿过目标表面或输入为空时返回 std::nullopt
+     */
+    std::optional<BooleanResult> cutTrivial(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                            const PreparedTarget* prepared = nullptr,
+                                            const MR::AffineXf3f* rigidB2A = nullptr,
+                                            BooleanProfile* profile = nullptr) const;
+    
+    /**
+     * @brief 三角形包围盒与 box 相交的面：有空间索引时只访问相交的单元，否则遍历所有面
+     */
+    MR::FaceBitSet findFacesInBox(const MR::Mesh& mesh, const MR::Box3f& box,
+                                  const PreparedTarget* prepared) const;
+    
+    /**
+     * @brief 点是否在封闭网格内部：沿坐标轴发射射线，只检测射线经过的面，按交点个数的奇偶判断
+     * @param meshBox 网格的包围盒
+     * @return 三个方向的射线都擦过边或顶点时返回 std::nullopt
+     */
+    std::optional<bool> containsPoint(const MR::Mesh& mesh, const MR::Box3f& meshBox,
+                                      const MR::Vector3f& point, const PreparedTarget* prepared) const;
+    
+    /**
+     * @brief 在完整网格上执行单次切割
+     * @param mapper 可选输出，切开后的 A/B 顶点到差集结果的映射
+     */
+    BooleanResult cutFull(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                          MR::BooleanResultMapper* mapper = nullptr,
+                          const MR::ProgressCallback& cb = {},
+                          const MR::AffineXf3f* rigidB2A = nullptr);
+    
+    /**
+     * @brief 只在刀具附近的窗口内执行切割，再缝回原网格
+     * @return 窗口无法使用时（窗口过大、无交线、缝合失败）返回 std::nullopt
+     */
+    std::optional<BooleanResult> cutWindowed(const MR::Mesh& meshA, const MR::Mesh& meshB,
+                                             const PreparedTarget* prepared = nullptr,
+                                             const MR::ProgressCallback& cb = {},
+                                             const MR::AffineXf3f* rigidB2A = nullptr);
+    
+    /**
+     * @brief 并行归约求 cutters[indices[begin, end)] 的并集
+     */
+    BooleanResult unionRange(std::span<const MR::Mesh> cutters,
+                             const std::vector<size_t>& indices,
+                             size_t begin, size_t end);
+    
+    WindowParams windowParams_;
+    
+    // 切割缓存（cut() 可能在多个线程中并行调用，缓存内部加锁）
+    std::unique_ptr<CutCache> cache_;
+    bool cacheEnabled_ = true;
+    
+    // 解析圆柱内核的刀具（只在开始切割前设置）
+    const MR::Mesh* cylinderMesh_ = nullptr;
+    CylinderParams cylinderParams_;
+    float chordTolerance_ = 0.01f;
 };
@@ -0,0 +1,119 @@
+/**
+ * @file BooleanWorker.cpp
+ * @brief 异步布尔运算工作器实现
+ */
+
+#include "BooleanWorker.h"
+#include <QMetaObject>
+
+BooleanWorker::BooleanWorker(QObject* parent)
+    : QObject(parent)
+{
+}
+
+BooleanWorker::~BooleanWorker()
+{
+    // 排队中的 finished 处理会随本对象销毁而丢弃，尚未处理的线程在这里结束并释放
+    cancelAll();
+    for (const auto& state : jobs_)
+    {
+        state->thread->quit();
+        state->thread->wait();
+        delete state->thread;
+    }
+    jobs_.clear();
+}
+
+quint64 BooleanWorker::start(Job job, QThread::Priority priority)
+{
+    auto state = std::make_shared<JobState>();
+    state->id = nextJobId_++;
+    
+    // 进度回调在后台线程中调用：按百分比节流后转发到 GUI 线程
+    MR::ProgressCallback cb = [this, state](float progress) -> bool
+    {
+        const int percent = static_cast<int>(progress * 100.0f);
+        if (state->lastPercent.exchange(percent) != percent)
+        {
+            QMetaObject::invokeMethod(this, [this, id = state->id, progress]()
+            {
+                emit progressChanged(id, progress);
+            }, Qt::QueuedConnection);
+        }
+        return !state->canceled.load();
+    };
+    
+    state->thread = QThread::create([this, state, job = std::move(job), cb]() mutable
+    {
+        auto result = std::make_shared<BooleanResult>(job(cb));
+        
+        // 任务捕获的快照（网格句柄、空间索引、引擎）立即释放，不等线程对象销毁
+        job = Job();
+        QMetaObject::invokeMethod(this, [this, state, result]()
+        {
+            emit finished(state->id, result);
+        }, Qt::QueuedConnection);
+    });
+    
+    connect(state->thread, &QThread::finished, this, [this, state]()
+    {
+        jobs_.removeOne(state);
+        state->thread->deleteLater();
+    });
+    
+    jobs_.append(state);
+    state->thread->start(priority);
+    
+    return state->id;
+}
+
+void BooleanWorker::cancel(quint64 jobId)
+{
+    for (const auto& state : jobs_)
+    {
+        if (state->id == jobId)
+        {
+            state->canceled = true;
+        }
+    }
+}
+
+void BooleanWorker::setPriority(quint64 jobId, QThread::Priority priority)
+{
+    for (const auto& state : jobs_)
+    {
+        if (state->id == jobId && state->thread->isRunning())
+        {
+            state->thread->setPriority(priority);
+        }
+    }
+}
+
+void BooleanWorker::cancelAll()
+{
+    for (const auto& state : jobs_)
+    {
+        state->canceled = true;
+    }
+}
+
+void BooleanWorker::waitForIdle()
+{
+    // 任务仍留在 jobs_ 中，线程对象由排队的 QThread::finished 处理或析构函数释放
+    for (const auto& state : jobs_)
+    {
+        state->thread->wait();
+    }
+}
+
+bool BooleanWorker::isBusy() const
+{
+    for (const auto& state : jobs_)
+    {
+        if (state->thread->isRunning())
+        {
+            return true;
+        }
+    }
+    return false;
+}
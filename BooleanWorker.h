@@ -0,0 +1,97 @@
+/**
+ * @file BooleanWorker.h
+ * @brief 异步布尔运算工作器
+ * 
+ * 在后台线程中执行布尔运算，通过信号向 GUI 线程汇报进度和结果，
+ * 支持随时取消
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <QList>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "BooleanOperator.h"
+
+/**
+ * @brief 异步布尔运算工作器类
+ * 
+ * 工作器对象本身位于 GUI 线程，每个任务在独立的 QThread 中运行，
+ * 信号总是在 GUI 线程中发出
+ */
+class BooleanWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 后台任务：接收进度回调，返回运算结果
+     */
+    using Job = std::function<BooleanResult(const MR::ProgressCallback&)>;
+    
+    explicit BooleanWorker(QObject* parent = nullptr);
+    ~BooleanWorker();
+    
+    /**
+     * @brief 在后台线程中启动任务
+     * @param job 任务
+     * @param priority 线程优先级
+     * @return 任务编号，用于匹配 progressChanged / finished 信号
+     */
+    quint64 start(Job job, QThread::Priority priority = QThread::NormalPriority);
+    
+    /**
+     * @brief 请求取消指定任务（任务会在下一个进度汇报点结束），不等待；
+     *        调用方忘记该任务编号即可丢弃其迟到的 finished 结果
+     */
+    void cancel(quint64 jobId);
+    
+    /**
+     * @brief 修改正在运行的任务的线程优先级
+     */
+    void setPriority(quint64 jobId, QThread::Priority priority);
+    
+    /**
+     * @brief 请求取消所有正在运行的任务
+     */
+    void cancelAll();
+    
+    /**
+     * @brief 阻塞等待所有后台线程结束
+     */
+    void waitForIdle();
+    
+    /**
+     * @brief 是否有任务正在运行
+     */
+    bool isBusy() const;
+
+signals:
+    /**
+     * @brief 任务进度改变（0 ~ 1）
+     */
+    void progressChanged(quint64 jobId, float progress);
+    
+    /**
+     * @brief 任务结束（包括失败和被取消）
+     */
+    void finished(quint64 jobId, std::shared_ptr<BooleanResult> result);
+
+private:
+    /**
+     * @brief 单个任务的共享状态
+     */
+    struct JobState
+    {
+        quint64 id = 0;
+        QThread* thread = nullptr;
+        std::atomic<bool> canceled{false};
+        std::atomic<int> lastPercent{-1};
+    };
+    
+    QList<std::shared_ptr<JobState>> jobs_;
+    quint64 nextJobId_ = 1;
+};
@@ -0,0 +1,127 @@
+/**
+ * @file CutCache.cpp
+ * @brief 切割结果缓存实现
+ */
+
+#include "CutCache.h"
+
+CutCache::CutCache(size_t memoryLimitBytes, size_t maxEntries)
+    : memoryLimit_(memoryLimitBytes)
+    , maxEntries_(maxEntries)
+{
+}
+
+std::shared_ptr<const BooleanResult> CutCache::find(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = index_.find(key);
+    if (it == index_.end())
+    {
+        ++stats_.misses;
+        return nullptr;
+    }
+    
+    ++stats_.hits;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->result;
+}
+
+void CutCache::insert(const Key& key, std::shared_ptr<const BooleanResult> result)
+{
+    if (!result)
+    {
+        return;
+    }
+    
+    const size_t bytes = resultBytes(*result);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (bytes > memoryLimit_)
+    {
+        return;
+    }
+    
+    if (auto it = index_.find(key); it != index_.end())
+    {
+        stats_.bytes -= it->second->bytes;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+    
+    lru_.push_front(Entry{key, std::move(result), bytes});
+    index_[key] = lru_.begin();
+    stats_.bytes += bytes;
+    
+    evict();
+}
+
+void CutCache::releaseMesh(const MeshHandle& mesh)
+{
+    if (!mesh)
+    {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();)
+    {
+        if (it->result->mesh.version() == mesh.version())
+        {
+            stats_.bytes -= it->bytes;
+            index_.erase(it->key);
+            it = lru_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void CutCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    stats_.bytes = 0;
+}
+
+void CutCache::setMemoryLimit(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    memoryLimit_ = bytes;
+    evict();
+}
+
+CutCache::Stats CutCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = lru_.size();
+    return stats;
+}
+
+size_t CutCache::resultBytes(const BooleanResult& result)
+{
+    size_t bytes = result.mesh.heapBytes() + result.cutPiece.heapBytes() +
+                   result.removedFaces.heapBytes() + result.addedFaces.heapBytes();
+    for (const auto& contour : result.contours)
+    {
+        bytes += contour.capacity() * sizeof(contour[0]);
+    }
+    return bytes;
+}
+
+void CutCache::evict()
+{
+    while (!lru_.empty() && (stats_.bytes > memoryLimit_ || lru_.size() > maxEntries_))
+    {
+        const Entry& oldest = lru_.back();
+        stats_.bytes -= oldest.bytes;
+        index_.erase(oldest.key);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * @file CutCache.h
+ * @brief 切割结果缓存
+ * 
+ * 以目标网格内容哈希和量化后的刀具几何为键，缓存最近的切割结果。
+ * 撤销后在同一位置重新切割、或在未改变的零件上重复同样的孔位时直接命中
+ */
+
+#pragma once
+
+#include "BooleanOperator.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief 有内存上限的 LRU 切割缓存（线程安全）
+ */
+class CutCache
+{
+public:
+    /**
+     * @brief 缓存键
+     */
+    struct Key
+    {
+        uint64_t target = 0;   ///< 目标网格内容哈希（MeshHash::meshHash）
+        uint64_t cutter = 0;   ///< 刀具哈希（MeshHash::cutterHash）
+        
+        bool operator==(const Key& other) const = default;
+    };
+    
+    /**
+     * @brief 命中统计
+     */
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+    
+    explicit CutCache(size_t memoryLimitBytes = size_t(256) << 20, size_t maxEntries = 64);
+    ~CutCache() = default;
+    
+    CutCache(const CutCache&) = delete;
+    CutCache& operator=(const CutCache&) = delete;
+    
+    /**
+     * @brief 查找缓存结果，命中时移到最近使用的位置
+     */
+    std::shared_ptr<const BooleanResult> find(const Key& key);
+    
+    /**
+     * @brief 插入结果，超出上限时淘汰最久未使用的条目；
+     *        单个结果超过内存上限时不缓存
+     */
+    void insert(const Key& key, std::shared_ptr<const BooleanResult> result);
+    
+    /**
+     * @brief 丢弃结果网格为 mesh 的条目，释放缓存对该网格的引用（之后可就地修改它）
+     */
+    void releaseMesh(const MeshHandle& mesh);
+    
+    /**
+     * @brief 清空缓存（统计保留）
+     */
+    void clear();
+    
+    /**
+     * @brief 设置内存上限（字节）
+     */
+    void setMemoryLimit(size_t bytes);
+    
+    /**
+     * @brief 获取统计信息
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 结果占用的堆内存
+     */
+    static size_t resultBytes(const BooleanResult& result);
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return static_cast<size_t>(key.target ^ (key.cutter * 0x9e3779b97f4a7c15ull));
+        }
+    };
+    
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const BooleanResult> result;
+        size_t bytes = 0;
+    };
+    
+    void evict();
+    
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  ///< 表头为最近使用
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+    size_t memoryLimit_;
+    size_t maxEntries_;
+    Stats stats_;
+};
@@ -0,0 +1,296 @@
+/**
+ * @file CutHistory.cpp
+ * @brief 切割历史实现
+ */
+
+#include "CutHistory.h"
+#include <MRMesh/MRMeshBuilder.h>
+#include <algorithm>
+
+CutHistory::CutHistory(size_t memoryLimitBytes)
+    : memoryLimit_(memoryLimitBytes)
+{
+}
+
+void CutHistory::clear()
+{
+    entries_.clear();
+    cursor_ = 0;
+    memoryUsage_ = 0;
+}
+
+void CutHistory::push(const MeshHandle& before,
+                      const MR::FaceBitSet& removedFaces, const MR::FaceBitSet& addedFaces,
+                      const MassProperties& massDelta, bool attached)
+{
+    if (!before)
+    {
+        return;
+    }
+    
+    // 窗口切割保留了未改动元素的编号，只需保存被删除的面和它们的顶点；
+    // 新增的面在撤销时从当前网格取出
+    Entry entry;
+    entry.region = capture(*before, removedFaces);
+    entry.removedFaces = removedFaces;
+    entry.addedFaces = addedFaces;
+    entry.massDelta = massDelta;
+    entry.bytes = entry.region.heapBytes() + removedFaces.heapBytes() + addedFaces.heapBytes();
+    
+    // 差异不比完整网格小多少时，直接保存检查点
+    if (entry.bytes > before->heapBytes() / 2)
+    {
+        pushReplace(before, massDelta, attached);
+        return;
+    }
+    pushEntry(std::move(entry), attached);
+}
+
+void CutHistory::pushReplace(const MeshHandle& before, const MassProperties& massDelta, bool attached)
+{
+    if (!before)
+    {
+        return;
+    }
+    
+    Entry entry;
+    entry.snapshot = before;
+    entry.massDelta = massDelta;
+    entry.bytes = before->heapBytes();
+    pushEntry(std::move(entry), attached);
+}
+
+void CutHistory::pushEntry(Entry entry, bool attached)
+{
+    // 丢弃可重做的步骤
+    while (entries_.size() > cursor_)
+    {
+        memoryUsage_ -= entries_.back().bytes;
+        entries_.pop_back();
+    }
+    
+    entry.attached = attached && cursor_ > 0;
+    memoryUsage_ += entry.bytes;
+    entries_.push_back(std::move(entry));
+    cursor_ = entries_.size();
+    
+    evict();
+}
+
+CutHistory::Step CutHistory::undo(MeshHandle current)
+{
+    if (!canUndo() || !current)
+    {
+        Step step;
+        step.mesh = std::move(current);
+        return step;
+    }
+    return swapEntry(entries_[--cursor_], std::move(current), true);
+}
+
+CutHistory::Step CutHistory::redo(MeshHandle current)
+{
+    if (!canRedo() || !current)
+    {
+        Step step;
+        step.mesh = std::move(current);
+        return step;
+    }
+    return swapEntry(entries_[cursor_++], std::move(current), false);
+}
+
+CutHistory::Step CutHistory::undoChain(MeshHandle current)
+{
+    Step total;
+    total.mesh = std::move(current);
+    total.incremental = true;
+    
+    bool continues = true;
+    while (continues && canUndo())
+    {
+        continues = undoContinues();
+        chain(total, undo(std::move(total.mesh)));
+    }
+    return total;
+}
+
+CutHistory::Step CutHistory::redoChain(MeshHandle current)
+{
+    Step total;
+    total.mesh = std::move(current);
+    total.incremental = true;
+    
+    if (canRedo())
+    {
+        chain(total, redo(std::move(total.mesh)));
+        while (redoContinues())
+        {
+            chain(total, redo(std::move(total.mesh)));
+        }
+    }
+    return total;
+}
+
+void CutHistory::chain(Step& total, Step next)
+{
+    total.mesh = std::move(next.mesh);
+    total.massDelta += next.massDelta;
+    if (!total.incremental || !next.incremental)
+    {
+        total.incremental = false;
+        total.removedFaces.clear();
+        total.addedFaces.clear();
+        return;
+    }
+    
+    // 合并相邻两步（R、A 为各步删除和新增的面，编号可能在两步之间被重用）：
+    // 删除 = R1 ∪ (R2 \ A1)，新增 = (A1 \ R2) ∪ A2，只访问改动的面
+    for (MR::FaceId f : next.removedFaces)
+    {
+        if (f < total.addedFaces.size() && total.addedFaces.test(f))
+        {
+            total.addedFaces.reset(f);
+        }
+        else
+        {
+            total.removedFaces.autoResizeSet(f);
+        }
+    }
+    for (MR::FaceId f : next.addedFaces)
+    {
+        total.addedFaces.autoResizeSet(f);
+    }
+}
+
+CutHistory::Step CutHistory::swapEntry(Entry& entry, MeshHandle current, bool undo)
+{
+    Step step;
+    step.massDelta = undo ? MassProperties() - entry.massDelta : entry.massDelta;
+    
+    if (!entry.snapshot)
+    {
+        // 就地替换切割区域的面，区域随之变为反向差异，耗时与改动大小成正比
+        MR::Mesh& mesh = current.edit();
+        replaceFaces(mesh, undo ? entry.addedFaces : entry.removedFaces, entry.region);
+        mesh.invalidateCaches();
+        
+        step.mesh = std::move(current);
+        step.incremental = true;
+        step.removedFaces = undo ? entry.addedFaces : entry.removedFaces;
+        step.addedFaces = undo ? entry.removedFaces : entry.addedFaces;
+        updateBytes(entry, entry.region.heapBytes() + entry.removedFaces.heapBytes() + entry.addedFaces.heapBytes());
+        return step;
+    }
+    
+    // 检查点：与当前网格交换句柄。之后的修改都经过 edit()，共享的检查点不会被改动
+    step.mesh = std::move(entry.snapshot);
+    entry.snapshot = std::move(current);
+    step.incremental = false;
+    updateBytes(entry, entry.snapshot->heapBytes());
+    return step;
+}
+
+size_t CutHistory::Region::heapBytes() const
+{
+    return triangles.capacity() * sizeof(triangles[0]) + points.capacity() * sizeof(points[0]);
+}
+
+CutHistory::Region CutHistory::capture(const MR::Mesh& mesh, const MR::FaceBitSet& faces)
+{
+    Region region;
+    const MR::MeshTopology& topology = mesh.topology;
+    
+    std::vector<MR::VertId> verts;
+    for (MR::FaceId f : faces)
+    {
+        if (!topology.hasFace(f))
+        {
+            continue;
+        }
+        const MR::ThreeVertIds tri = topology.getTriVerts(f);
+        region.triangles.emplace_back(f, tri);
+        verts.insert(verts.end(), tri.begin(), tri.end());
+    }
+    
+    std::sort(verts.begin(), verts.end());
+    verts.erase(std::unique(verts.begin(), verts.end()), verts.end());
+    region.points.reserve(verts.size());
+    for (MR::VertId v : verts)
+    {
+        region.points.emplace_back(v, mesh.points[v]);
+    }
+    return region;
+}
+
+void CutHistory::replaceFaces(MR::Mesh& mesh, const MR::FaceBitSet& faces, Region& region)
+{
+    Region removed = capture(mesh, faces);
+    MR::MeshTopology& topology = mesh.topology;
+    
+    // 删除面时一并删除不再被其他面使用的边和顶点
+    for (const auto& [f, tri] : removed.triangles)
+    {
+        topology.deleteFace(f);
+    }
+    
+    if (!region.triangles.empty())
+    {
+        // 按原编号加入三角形，与区域外保留的边界边重新连接；
+        // 部分三角形要等相邻的三角形加入后才能加入，重复直到不再有进展
+        const int faceSize = std::max(int(topology.faceSize()), int(region.triangles.back().first) + 1);
+        MR::Triangulation tris(faceSize);
+        MR::FaceBitSet pending(faceSize);
+        for (const auto& [f, tri] : region.triangles)
+        {
+            tris[f] = tri;
+            pending.set(f);
+        }
+        
+        MR::MeshBuilder::BuildSettings settings;
+        settings.region = &pending;
+        size_t left = pending.count();
+        while (left > 0)
+        {
+            MR::MeshBuilder::addTriangles(topology, tris, settings);
+            const size_t now = pending.count();
+            if (now == left)
+            {
+                break;
+            }
+            left = now;
+        }
+    }
+    
+    mesh.points.resizeWithReserve(topology.vertSize());
+    for (const auto& [v, p] : region.points)
+    {
+        mesh.points[v] = p;
+    }
+    
+    region = std::move(removed);
+}
+
+void CutHistory::updateBytes(Entry& entry, size_t bytes)
+{
+    memoryUsage_ = memoryUsage_ - entry.bytes + bytes;
+    entry.bytes = bytes;
+}
+
+void CutHistory::evict()
+{
+    // 从最早的步骤开始丢弃，至少保留最近一步
+    while (memoryUsage_ > memoryLimit_ && entries_.size() > 1 && cursor_ > 1)
+    {
+        memoryUsage_ -= entries_.front().bytes;
+        entries_.pop_front();
+        --cursor_;
+        
+        // 附属于被丢弃步骤的后续步骤不能再单独撤销到中间状态，一并丢弃
+        while (cursor_ > 1 && entries_.front().attached)
+        {
+            memoryUsage_ -= entries_.front().bytes;
+            entries_.pop_front();
+            --cursor_;
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * @file CutHistory.h
+ * @brief 切割历史（撤销/重做）
+ * 
+ * 每一步只记录切割区域在另一侧状态下的三角形和顶点坐标，
+ * 编号全部改变或改动过大时改存完整网格作为检查点
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRBitSet.h>
+#include "MeshHandle.h"
+#include "MassProperties.h"
+#include <deque>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 切割历史类
+ * 
+ * 撤销和重做直接在当前网格上应用差异，耗时与改动大小成正比。
+ * 历史占用的内存超过上限时丢弃最早的步骤
+ */
+class CutHistory
+{
+public:
+    /**
+     * @brief 撤销或重做一步后的状态
+     */
+    struct Step
+    {
+        MeshHandle mesh;                 ///< 新的当前网格
+        bool incremental = false;        ///< 是否为增量改动（否则为整体替换）
+        MR::FaceBitSet removedFaces;     ///< 增量改动删除的面
+        MR::FaceBitSet addedFaces;       ///< 增量改动新增的面
+        MassProperties massDelta;        ///< 质量特性的变化（新的当前网格 - 原网格）
+    };
+    
+    explicit CutHistory(size_t memoryLimitBytes = size_t(512) << 20);
+    ~CutHistory() = default;
+    
+    /**
+     * @brief 清空历史
+     */
+    void clear();
+    
+    /**
+     * @brief 记录一次保留未改动元素编号的切割，并丢弃所有可重做的步骤
+     * 
+     * 只从 before 中取出被删除的面及其顶点，耗时与改动大小成正比
+     * 
+     * @param before 切割前的网格（改动过大时共享保存为检查点，不复制）
+     * @param removedFaces 切割删除的面（before 的编号），可以为空（如只新增空腔面）
+     * @param addedFaces 切割新增的面（切割后网格的编号）
+     * @param massDelta 切割引起的质量特性变化（切割后 - 切割前），撤销/重做时直接加减
+     * @param attached 是否为上一步的后续处理（如后台简化），与上一步一起撤销/重做
+     */
+    void push(const MeshHandle& before,
+              const MR::FaceBitSet& removedFaces, const MR::FaceBitSet& addedFaces,
+              const MassProperties& massDelta, bool attached = false);
+    
+    /**
+     * @brief 记录一次整体替换（编号不再对应），保存切割前的网格作为检查点
+     * @param before 切割前的网格（共享保存，不复制）
+     * @param massDelta、attached 同 push()
+     */
+    void pushReplace(const MeshHandle& before, const MassProperties& massDelta, bool attached = false);
+    
+    bool canUndo() const { return cursor_ > 0; }
+    bool canRedo() const { return cursor_ < entries_.size(); }
+    
+    /**
+     * @brief 下一步撤销的步骤是否附属于它之前的一步（撤销后应继续撤销）
+     */
+    bool undoContinues() const { return canUndo() && entries_[cursor_ - 1].attached; }
+    
+    /**
+     * @brief 下一步重做的步骤是否附属于刚重做的一步（应继续重做）
+     */
+    bool redoContinues() const { return canRedo() && cursor_ > 0 && entries_[cursor_].attached; }
+    
+    /**
+     * @brief 撤销一步
+     * @param current 当前网格。增量步骤在调用方交出的唯一句柄上就地修改，
+     *        网格仍被其他句柄共享时先复制
+     */
+    Step undo(MeshHandle current);
+    
+    /**
+     * @brief 重做一步
+     * @param current 当前网格，同 undo()
+     */
+    Step redo(MeshHandle current);
+    
+    /**
+     * @brief 撤销一步及附属于它的所有步骤
+     * 
+     * 各步骤依次在同一个网格上应用，网格只在第一步被共享时复制一次；
+     * 返回合并后的改动，调用方只需发布一次
+     * 
+     * @param current 当前网格，同 undo()
+     */
+    Step undoChain(MeshHandle current);
+    
+    /**
+     * @brief 重做一步及附属于它的所有后续步骤，同 undoChain()
+     */
+    Step redoChain(MeshHandle current);
+    
+    /**
+     * @brief 历史占用的内存（字节）
+     */
+    size_t memoryUsage() const { return memoryUsage_; }
+    
+    /**
+     * @brief 可撤销的步数
+     */
+    size_t undoCount() const { return cursor_; }
+
+private:
+    /**
+     * @brief 一侧状态下切割区域的三角形和顶点坐标（按编号排序）
+     */
+    struct Region
+    {
+        std::vector<std::pair<MR::FaceId, MR::ThreeVertIds>> triangles;
+        std::vector<std::pair<MR::VertId, MR::Vector3f>> points;
+        
+        size_t heapBytes() const;
+    };
+    
+    /**
+     * @brief 历史记录项：区域差异和检查点二选一
+     */
+    struct Entry
+    {
+        Region region;                        ///< 另一侧状态下切割区域的面和顶点
+        MeshHandle snapshot;                  ///< 另一侧状态的完整网格（检查点）
+        MR::FaceBitSet removedFaces;          ///< 切割删除的面
+        MR::FaceBitSet addedFaces;            ///< 切割新增的面
+        MassProperties massDelta;             ///< 切割引起的质量特性变化（切割后 - 切割前）
+        size_t bytes = 0;                     ///< 占用的内存
+        bool attached = false;                ///< 与上一步一起撤销/重做
+    };
+    
+    /**
+     * @brief 取出网格中给定面的三角形及其顶点坐标
+     */
+    static Region capture(const MR::Mesh& mesh, const MR::FaceBitSet& faces);
+    
+    /**
+     * @brief 在网格上删除给定的面，换成区域中保存的面（保持原编号）；
+     *        区域随之变为被删除的面，用于反向操作
+     */
+    static void replaceFaces(MR::Mesh& mesh, const MR::FaceBitSet& faces, Region& region);
+    
+    void pushEntry(Entry entry, bool attached);
+    Step swapEntry(Entry& entry, MeshHandle current, bool undo);
+    static void chain(Step& total, Step next);
+    void updateBytes(Entry& entry, size_t bytes);
+    void evict();
+    
+    std::deque<Entry> entries_;
+    size_t cursor_ = 0;           ///< entries_[0, cursor_) 可撤销，其余可重做
+    size_t memoryLimit_ = 0;
+    size_t memoryUsage_ = 0;
+};
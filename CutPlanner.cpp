@@ -0,0 +1,337 @@
+/**
+ * @file CutPlanner.cpp
+ * @brief 切割规划器实现
+ */
+
+#include "CutPlanner.h"
+#include <MRMesh/MRExpandShrink.h>
+#include <MRMesh/MRParallelFor.h>
+#include <MRMesh/MRBox.h>
+#include <chrono>
+#include <iterator>
+#include <numeric>
+
+namespace
+{
+    /**
+     * @brief 简单的并查集
+     */
+    class DisjointSets
+    {
+    public:
+        explicit DisjointSets(size_t n) : parent_(n)
+        {
+            std::iota(parent_.begin(), parent_.end(), size_t(0));
+        }
+        
+        size_t find(size_t i)
+        {
+            while (parent_[i] != i)
+            {
+                parent_[i] = parent_[parent_[i]];
+                i = parent_[i];
+            }
+            return i;
+        }
+        
+        void unite(size_t a, size_t b)
+        {
+            a = find(a);
+            b = find(b);
+            if (a != b)
+            {
+                parent_[std::max(a, b)] = std::min(a, b);
+            }
+        }
+        
+        /**
+         * @brief 按根节点收集各组成员
+         */
+        std::vector<std::vector<size_t>> groups()
+        {
+            std::vector<std::vector<size_t>> result;
+            std::vector<size_t> rootToGroup(parent_.size(), SIZE_MAX);
+            for (size_t i = 0; i < parent_.size(); ++i)
+            {
+                size_t root = find(i);
+                if (rootToGroup[root] == SIZE_MAX)
+                {
+                    rootToGroup[root] = result.size();
+                    result.emplace_back();
+                }
+                result[rootToGroup[root]].push_back(i);
+            }
+            return result;
+        }
+    
+    private:
+        std::vector<size_t> parent_;
+    };
+    
+    float elapsedMs(std::chrono::high_resolution_clock::time_point from,
+                    std::chrono::high_resolution_clock::time_point to)
+    {
+        std::chrono::duration<double, std::milli> elapsed = to - from;
+        return static_cast<float>(elapsed.count());
+    }
+    
+    /**
+     * @brief 把在 first 的结果网格上继续切割得到的 next 并入 first
+     */
+    void mergeResult(BooleanResult& first, BooleanResult next)
+    {
+        if (next.windowed || next.cavity)
+        {
+            // 编号保留（R、A 为两次删除和新增的面）：
+            // 删除 = R1 ∪ (R2 \ A1)，新增 = (A1 \ R2) ∪ A2
+            for (MR::FaceId f : next.removedFaces)
+            {
+                if (f < first.addedFaces.size() && first.addedFaces.test(f))
+                {
+                    first.addedFaces.reset(f);
+                }
+                else
+                {
+                    first.removedFaces.autoResizeSet(f);
+                }
+            }
+            for (MR::FaceId f : next.addedFaces)
+            {
+                first.addedFaces.autoResizeSet(f);
+            }
+            first.addedFaces.resize(next.mesh->topology.faceSize());
+        }
+        else
+        {
+            // 整体替换，编号不再对应
+            first.windowed = false;
+            first.removedFaces.clear();
+            first.addedFaces.clear();
+        }
+        
+        first.mesh = std::move(next.mesh);
+        first.massDelta += next.massDelta;
+        first.hasMassDelta = first.hasMassDelta && next.hasMassDelta;
+        if (next.cutPiece)
+        {
+            if (first.cutPiece)
+            {
+                first.cutPiece.edit().addMesh(*next.cutPiece);
+            }
+            else
+            {
+                first.cutPiece = std::move(next.cutPiece);
+            }
+        }
+        first.contours.insert(first.contours.end(),
+                              std::make_move_iterator(next.contours.begin()),
+                              std::make_move_iterator(next.contours.end()));
+        first.profile += next.profile;
+    }
+}
+
+CutPlanner::CutPlanner(BooleanOperator& booleanOp)
+    : booleanOp_(booleanOp)
+{
+}
+
+std::vector<std::vector<size_t>> CutPlanner::clusterByOverlap(std::span<const MR::Box3f> boxes)
+{
+    DisjointSets sets(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        for (size_t j = i + 1; j < boxes.size(); ++j)
+        {
+            if (boxes[i].intersects(boxes[j]))
+            {
+                sets.unite(i, j);
+            }
+        }
+    }
+    return sets.groups();
+}
+
+PlanResult CutPlanner::execute(const PreparedTarget& target, std::span<const MR::Mesh> cutters)
+{
+    PlanResult plan;
+    
+    const auto& meshPtr = target.getMesh();
+    if (!meshPtr || cutters.empty())
+    {
+        plan.boolean.errorMsg = "Mesh A is empty";
+        return plan;
+    }
+    const MR::Mesh& meshA = *meshPtr;
+    
+    auto fallBack = [&]()
+    {
+        BatchResult batch = booleanOp_.differenceMany(meshA, cutters);
+        plan.boolean = std::move(batch.boolean);
+        plan.fellBack = true;
+    };
+    
+    auto planStart = std::chrono::high_resolution_clock::now();
+    
+    // 1. 剔除不接触材料的刀具，其余按（包围盒 + 余量）重叠关系初步分组
+    std::vector<CutterPlacement> placements(cutters.size());
+    MR::ParallelFor(size_t(0), cutters.size(), [&](size_t i)
+    {
+        placements[i] = booleanOp_.classify(meshA, cutters[i], &target);
+    });
+    
+    std::vector<size_t> active;
+    for (size_t i = 0; i < cutters.size(); ++i)
+    {
+        if (placements[i] != CutterPlacement::Outside && placements[i] != CutterPlacement::InRemoved)
+        {
+            active.push_back(i);
+        }
+    }
+    
+    if (active.empty())
+    {
+        plan.boolean.placement = CutterPlacement::InRemoved;
+        plan.boolean.unchanged = true;
+        plan.boolean.success = true;
+        plan.planMs = elapsedMs(planStart, std::chrono::high_resolution_clock::now());
+        plan.boolean.durationMs = plan.planMs;
+        return plan;
+    }
+    
+    const float margin = booleanOp_.getWindowParams().margin;
+    std::vector<MR::Box3f> boxes(active.size());
+    for (size_t k = 0; k < active.size(); ++k)
+    {
+        boxes[k] = cutters[active[k]].computeBoundingBox().expanded(MR::Vector3f::diagonal(margin));
+    }
+    std::vector<std::vector<size_t>> clusters = clusterByOverlap(boxes);
+    for (auto& cluster : clusters)
+    {
+        for (size_t& i : cluster)
+        {
+            i = active[i];
+        }
+    }
+    
+    // 2. 为每组选取窗口；窗口向外扩展一圈后仍然相交的组必须合并，
+    //    否则两个窗口共享的边界边会在删除面时一并消失
+    std::vector<MR::FaceBitSet> windows(clusters.size(), MR::FaceBitSet(meshA.topology.faceSize()));
+    MR::ParallelFor(size_t(0), clusters.size(), [&](size_t c)
+    {
+        for (size_t i : clusters[c])
+        {
+            windows[c] |= booleanOp_.selectWindowFaces(meshA, cutters[i].computeBoundingBox(), &target);
+        }
+    });
+    
+    DisjointSets windowSets(clusters.size());
+    MR::Vector<int, MR::FaceId> owner(meshA.topology.faceSize(), -1);
+    for (size_t c = 0; c < clusters.size(); ++c)
+    {
+        MR::FaceBitSet grown = windows[c];
+        MR::expand(meshA.topology, grown, 1);
+        for (MR::FaceId f : grown)
+        {
+            if (owner[f] >= 0)
+            {
+                windowSets.unite(c, static_cast<size_t>(owner[f]));
+            }
+            else
+            {
+                owner[f] = static_cast<int>(c);
+            }
+        }
+    }
+    
+    std::vector<std::vector<size_t>> mergedCutters;
+    std::vector<MR::FaceBitSet> mergedWindows;
+    size_t totalWindowFaces = 0;
+    for (const auto& group : windowSets.groups())
+    {
+        std::vector<size_t> members;
+        MR::FaceBitSet window(meshA.topology.faceSize());
+        for (size_t c : group)
+        {
+            members.insert(members.end(), clusters[c].begin(), clusters[c].end());
+            window |= windows[c];
+        }
+        totalWindowFaces += window.count();
+        mergedCutters.push_back(std::move(members));
+        mergedWindows.push_back(std::move(window));
+    }
+    
+    plan.numClusters = static_cast<int>(mergedCutters.size());
+    auto planEnd = std::chrono::high_resolution_clock::now();
+    plan.planMs = elapsedMs(planStart, planEnd);
+    
+    if (totalWindowFaces > booleanOp_.getWindowParams().maxFaceRatio * meshA.topology.numValidFaces())
+    {
+        fallBack();
+        return plan;
+    }
+    
+    // 3. 每组一个局部布尔运算，在 TBB 线程池上并行执行
+    std::vector<std::optional<WindowPatch>> patches(mergedCutters.size());
+    MR::ParallelFor(size_t(0), mergedCutters.size(), [&](size_t c)
+    {
+        BooleanResult cutterUnion = booleanOp_.unionOf(cutters, mergedCutters[c]);
+        if (cutterUnion.success)
+        {
+            patches[c] = booleanOp_.cutWindow(meshA, *cutterUnion.mesh, std::move(mergedWindows[c]));
+        }
+    });
+    
+    auto cutEnd = std::chrono::high_resolution_clock::now();
+    plan.cutMs = elapsedMs(planEnd, cutEnd);
+    
+    // 无法局部处理的组（如刀具完全位于材料内部、没有交线）单独记下，其余照常合并
+    std::vector<WindowPatch> readyPatches;
+    readyPatches.reserve(patches.size());
+    std::vector<MR::Mesh> failedCutters;
+    for (size_t c = 0; c < patches.size(); ++c)
+    {
+        if (patches[c])
+        {
+            readyPatches.push_back(std::move(*patches[c]));
+            continue;
+        }
+        ++plan.numFailedClusters;
+        for (size_t i : mergedCutters[c])
+        {
+            failedCutters.push_back(cutters[i]);
+        }
+    }
+    
+    if (readyPatches.empty())
+    {
+        // 没有一组能局部处理，只对这些刀具做一次运算
+        BatchResult batch = booleanOp_.differenceMany(meshA, failedCutters);
+        plan.boolean = std::move(batch.boolean);
+        plan.fellBack = true;
+        return plan;
+    }
+    
+    // 4. 合并所有补丁到同一个结果网格
+    plan.boolean = BooleanOperator::stitchWindows(meshPtr, readyPatches);
+    
+    // 5. 失败的组在合并结果上单独运算（空腔、全局布尔），不重做已完成的局部切割
+    if (!failedCutters.empty())
+    {
+        BatchResult batch = booleanOp_.differenceMany(*plan.boolean.mesh, failedCutters);
+        if (!batch.boolean.success)
+        {
+            plan.boolean = std::move(batch.boolean);
+            return plan;
+        }
+        if (!batch.boolean.unchanged)
+        {
+            mergeResult(plan.boolean, std::move(batch.boolean));
+        }
+    }
+    
+    auto mergeEnd = std::chrono::high_resolution_clock::now();
+    plan.mergeMs = elapsedMs(cutEnd, mergeEnd);
+    plan.boolean.durationMs = elapsedMs(planStart, mergeEnd);
+    
+    return plan;
+}
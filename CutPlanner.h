@@ -0,0 +1,60 @@
+/**
+ * @file CutPlanner.h
+ * @brief 切割规划器
+ * 
+ * 把一批刀具按包围盒重叠关系分组，互不相关的分组并行做局部布尔运算，
+ * 最后把所有补丁合并到同一个结果网格中
+ */
+
+#pragma once
+
+#include "BooleanOperator.h"
+#include "PreparedTarget.h"
+#include <span>
+#include <vector>
+
+/**
+ * @brief 规划切割结果
+ */
+struct PlanResult
+{
+    BooleanResult boolean;       ///< 合并后的切割结果
+    int numClusters = 0;         ///< 并行执行的分组数
+    bool fellBack = false;       ///< 是否退回到 differenceMany 的全局运算
+    int numFailedClusters = 0;   ///< 无法局部处理、在合并结果上单独运算的分组数
+    float planMs = 0.0f;         ///< 分组和窗口选取耗时（毫秒）
+    float cutMs = 0.0f;          ///< 并行局部切割耗时（毫秒）
+    float mergeMs = 0.0f;        ///< 补丁合并耗时（毫秒）
+};
+
+/**
+ * @brief 切割规划器类
+ */
+class CutPlanner
+{
+public:
+    explicit CutPlanner(BooleanOperator& booleanOp);
+    ~CutPlanner() = default;
+    
+    /**
+     * @brief 从目标中减去所有刀具
+     * 
+     * 窗口互相重叠或相邻的刀具归为一组，每组只做一次局部布尔运算，
+     * 各组在 TBB 线程池上并行执行。无法局部处理的组（如完全位于材料内部的刀具）
+     * 在合并后的结果上用 differenceMany 单独运算；只有窗口总面数过多时才整体退回
+     * 
+     * @param target 预处理的目标网格
+     * @param cutters 切割工具网格列表
+     */
+    PlanResult execute(const PreparedTarget& target, std::span<const MR::Mesh> cutters);
+    
+    /**
+     * @brief 按包围盒重叠关系对刀具分组（传递闭包）
+     * @param boxes 刀具包围盒（已包含余量）
+     * @return 每组刀具的下标
+     */
+    static std::vector<std::vector<size_t>> clusterByOverlap(std::span<const MR::Box3f> boxes);
+
+private:
+    BooleanOperator& booleanOp_;
+};
@@ -0,0 +1,115 @@
+/**
+ * @file CutSimplifier.cpp
+ * @brief 切割区域的后台简化实现
+ */
+
+#include "CutSimplifier.h"
+#include <MRMesh/MRMeshDecimate.h>
+#include <MRMesh/MRRingIterator.h>
+#include <chrono>
+
+void CutSimplifier::addCut(const MR::FaceBitSet& removedFaces, const MR::FaceBitSet& addedFaces)
+{
+    // 只访问改动的面，耗时与改动大小成正比
+    for (MR::FaceId f : removedFaces)
+    {
+        if (f < region_.size())
+        {
+            region_.reset(f);
+        }
+    }
+    for (MR::FaceId f : addedFaces)
+    {
+        region_.autoResizeSet(f);
+    }
+}
+
+bool CutSimplifier::hasWork() const
+{
+    return params_.enabled && region_.count() >= static_cast<size_t>(params_.minRegionFaces);
+}
+
+BooleanResult CutSimplifier::simplify(const MR::Mesh& mesh, const MR::FaceBitSet& region,
+                                      const SimplifyParams& params, const MR::ProgressCallback& cb)
+{
+    BooleanResult result;
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    const MR::MeshTopology& topology = mesh.topology;
+    MR::FaceBitSet faces = region;
+    faces.resize(topology.faceSize());
+    faces &= topology.getValidFaces();
+    if (faces.none())
+    {
+        result.success = true;
+        result.unchanged = true;
+        return result;
+    }
+    
+    // 区域边界（以及网格边界）上的顶点和边保持不动：
+    // 与区域外的面相邻的顶点一定位于某条区域边界边上
+    MR::VertBitSet locked(topology.vertSize());
+    MR::UndirectedEdgeBitSet notFlippable(topology.undirectedEdgeSize());
+    for (MR::FaceId f : faces)
+    {
+        for (MR::EdgeId e : MR::leftRing(topology, f))
+        {
+            const MR::FaceId right = topology.right(e);
+            if (!right || !faces.test(right))
+            {
+                locked.set(topology.org(e));
+                locked.set(topology.dest(e));
+                notFlippable.set(e.undirected());
+            }
+        }
+    }
+    
+    MR::Mesh simplifiedMesh = mesh;
+    MR::FaceBitSet simplified = faces;
+    
+    MR::DecimateSettings settings;
+    settings.strategy = MR::DecimateStrategy::MinimizeError;
+    settings.maxError = params.maxError;
+    settings.maxTriangleAspectRatio = params.maxTriangleAspectRatio;
+    settings.region = &simplified;
+    settings.notFlippable = &notFlippable;
+    settings.preCollapse = [&](MR::EdgeId e, const MR::Vector3f&)
+    {
+        const MR::MeshTopology& current = simplifiedMesh.topology;
+        return !locked.test(current.org(e)) && !locked.test(current.dest(e));
+    };
+    settings.progressCallback = cb;
+    
+    const MR::DecimateResult decimated = MR::decimateMesh(simplifiedMesh, settings);
+    if (decimated.cancelled)
+    {
+        result.errorMsg = BooleanOperator::kCanceledMsg;
+        return result;
+    }
+    
+    if (decimated.facesDeleted == 0)
+    {
+        // 区域内已经没有能在容差内合并的边
+        result.success = true;
+        result.unchanged = true;
+        return result;
+    }
+    simplifiedMesh.invalidateCaches();
+    
+    // 未删除的面保持编号，区域外的面和顶点完全不变，可以按窗口切割的方式增量更新
+    simplified &= simplifiedMesh.topology.getValidFaces();
+    result.windowed = true;
+    result.removedFaces = std::move(faces);
+    result.addedFaces = std::move(simplified);
+    result.massDelta = MassProperties::compute(simplifiedMesh, &result.addedFaces) -
+                       MassProperties::compute(mesh, &result.removedFaces);
+    result.mesh = std::move(simplifiedMesh);
+    result.hasMassDelta = true;
+    result.success = true;
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    result.durationMs = static_cast<float>(elapsed.count());
+    
+    return result;
+}
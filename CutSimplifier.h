@@ -0,0 +1,88 @@
+/**
+ * @file CutSimplifier.h
+ * @brief 切割区域的后台简化
+ * 
+ * 每次切割都会在孔壁附近留下大量细小三角形，切割次数多了以后网格不断膨胀，
+ * 之后的每次切割和绘制都随之变慢。提交切割后在后台只对最近切割新增的面做减面，
+ * 误差控制在给定的几何容差内，其余部分保持原样（面和顶点编号不变）
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRBitSet.h>
+#include <MRMesh/MRProgressCallback.h>
+#include "BooleanOperator.h"
+
+/**
+ * @brief 简化参数
+ */
+struct SimplifyParams
+{
+    bool enabled = true;                ///< 是否在切割后自动简化
+    float maxError = 0.01f;             ///< 允许的最大几何偏差 (mm)
+    float maxTriangleAspectRatio = 20.0f;  ///< 简化后三角形的最大长宽比
+    int minRegionFaces = 200;           ///< 待简化区域少于该面数时不启动
+};
+
+/**
+ * @brief 切割区域简化器
+ * 
+ * 记录最近切割新增、尚未简化的面（当前网格编号）。窗口切割保留了未改动面的编号，
+ * 因此多次切割的区域可以累积，下一次后台简化一并处理
+ */
+class CutSimplifier
+{
+public:
+    CutSimplifier() = default;
+    ~CutSimplifier() = default;
+    
+    /**
+     * @brief 设置简化参数
+     */
+    void setParams(const SimplifyParams& params) { params_ = params; }
+    
+    /**
+     * @brief 获取简化参数
+     */
+    const SimplifyParams& getParams() const { return params_; }
+    
+    /**
+     * @brief 记录一次窗口切割（或一次简化）对网格的改动
+     * @param removedFaces 删除的面（改动前的编号），从待简化区域中移除
+     * @param addedFaces 新增的面（改动后的编号），加入待简化区域
+     */
+    void addCut(const MR::FaceBitSet& removedFaces, const MR::FaceBitSet& addedFaces);
+    
+    /**
+     * @brief 清空待简化区域（加载新网格、整体替换或撤销/重做后编号不再对应）
+     */
+    void clear() { region_.clear(); }
+    
+    /**
+     * @brief 待简化区域是否达到启动简化的规模
+     */
+    bool hasWork() const;
+    
+    /**
+     * @brief 待简化区域（当前网格编号）
+     */
+    const MR::FaceBitSet& getRegion() const { return region_; }
+    
+    /**
+     * @brief 简化网格中的指定区域
+     * 
+     * 与区域外的面相邻的顶点和边保持不动，因此区域外的面完全不变
+     * 
+     * @param mesh 目标网格（不会被修改）
+     * @param region 待简化的面
+     * @return mesh 为简化后的网格，removedFaces / addedFaces 分别为简化前后的区域，
+     *         massDelta 为区域内的质量特性变化；没有可简化的面时 unchanged 为 true
+     */
+    static BooleanResult simplify(const MR::Mesh& mesh, const MR::FaceBitSet& region,
+                                  const SimplifyParams& params, const MR::ProgressCallback& cb = {});
+
+private:
+    SimplifyParams params_;
+    MR::FaceBitSet region_;
+};
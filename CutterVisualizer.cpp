@@ -4,10 +4,12 @@
  */
 
 #include "CutterVisualizer.h"
+#include "BooleanWorker.h"
 #include <MRMesh/MRMeshSave.h>
 #include <MRMesh/MRBox.h>
 #include <QPainter>
 #include <QMouseEvent>
+#include <QTimer>
 #include <cmath>
 #include <vector>
 #include <algorithm>
@@ -42,25 +44,64 @@ CutterVisualizer::CutterVisualizer(QWidget* parent)
     setAutoFillBackground(true);
     
     offset_ = QPoint(width()/2, height()/2);
+    
+    // 滚轮缩放、移动刀具等离散交互停止后再按原网格重绘
+    interactionTimer_ = new QTimer(this);
+    interactionTimer_->setSingleShot(true);
+    interactionTimer_->setInterval(200);
+    connect(interactionTimer_, &QTimer::timeout, this, QOverload<>::of(&QWidget::update));
+    
+    // 切割、简化、压缩会在短时间内连续产生新网格，网格稳定后才构建代理和 AABB 树
+    buildWorker_ = new BooleanWorker(this);
+    connect(buildWorker_, &BooleanWorker::finished, this, &CutterVisualizer::onBuildFinished);
+    buildTimer_ = new QTimer(this);
+    buildTimer_->setSingleShot(true);
+    buildTimer_->setInterval(500);
+    connect(buildTimer_, &QTimer::timeout, this, &CutterVisualizer::startBackgroundBuilds);
 }
 
 CutterVisualizer::~CutterVisualizer() = default;
 
-void CutterVisualizer::setTargetMesh(const std::shared_ptr<MR::Mesh>& mesh)
+void CutterVisualizer::setTargetMesh(const MeshHandle& mesh)
 {
+    if (mesh.version() == targetMesh_.version())
+    {
+        return;
+    }
     targetMesh_ = mesh;
+    requestProxy(targetProxy_, targetMesh_);
+    requestTree(targetCache_);
     update();
 }
 
-void CutterVisualizer::setCutterMesh(const std::shared_ptr<MR::Mesh>& mesh)
+void CutterVisualizer::setCutterMesh(const MeshHandle& mesh)
 {
+    if (mesh.version() == cutterMesh_.version())
+    {
+        return;
+    }
     cutterMesh_ = mesh;
+    requestProxy(cutterProxy_, cutterMesh_);
+    requestTree(cutterCache_);
+    update();
+}
+
+void CutterVisualizer::setCutterTransform(const MR::AffineXf3f& xf)
+{
+    cutterXf_ = xf;
+    noteInteraction();
     update();
 }
 
-void CutterVisualizer::setResultMesh(const std::shared_ptr<MR::Mesh>& mesh)
+void CutterVisualizer::setResultMesh(const MeshHandle& mesh)
 {
+    if (mesh.version() == resultMesh_.version())
+    {
+        return;
+    }
     resultMesh_ = mesh;
+    requestProxy(resultProxy_, resultMesh_);
+    requestTree(resultCache_);
     update();
 }
 
@@ -69,9 +110,135 @@ void CutterVisualizer::clearAll()
     targetMesh_.reset();
     cutterMesh_.reset();
     resultMesh_.reset();
+    targetCache_ = RenderCache();
+    cutterCache_ = RenderCache();
+    resultCache_ = RenderCache();
+    requestProxy(targetProxy_, targetMesh_);
+    requestProxy(cutterProxy_, cutterMesh_);
+    requestProxy(resultProxy_, resultMesh_);
+    requestTree(targetCache_);
+    requestTree(cutterCache_);
+    requestTree(resultCache_);
+    targetProxyCache_ = RenderCache();
+    cutterProxyCache_ = RenderCache();
+    resultProxyCache_ = RenderCache();
+    targetLayer_ = RenderLayer();
+    cutterLayer_ = RenderLayer();
+    resultLayer_ = RenderLayer();
     update();
 }
 
+void CutterVisualizer::requestProxy(MeshProxy& proxy, const MeshHandle& mesh)
+{
+    // 旧网格的构建直接取消，不等待；新代理等网格稳定后再构建
+    if (const quint64 stale = proxy.setSource(mesh)) {
+        buildWorker_->cancel(stale);
+    }
+    if (proxy.needsBuild()) {
+        buildTimer_->start();
+    }
+}
+
+void CutterVisualizer::requestTree(RenderCache& cache)
+{
+    // 网格已改变：为旧版本构建的树不再需要，取消即可，不等待
+    for (auto it = treeJobs_.begin(); it != treeJobs_.end();) {
+        if (it->second.first == &cache) {
+            buildWorker_->cancel(it->first);
+            it = treeJobs_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    buildTimer_->start();
+}
+
+void CutterVisualizer::startBackgroundBuilds()
+{
+    // 原网格的 AABB 树：树建在网格自身的缓存里，绘制线程只在任务结束后读取
+    const std::pair<RenderCache*, const MeshHandle*> layers[] = {
+        {&targetCache_, &targetMesh_}, {&cutterCache_, &cutterMesh_}, {&resultCache_, &resultMesh_}};
+    for (const auto& [cache, meshPtr] : layers) {
+        const MeshHandle mesh = *meshPtr;
+        if (!mesh || cache->treeVersion == mesh.version()) {
+            continue;
+        }
+        const bool running = std::any_of(treeJobs_.begin(), treeJobs_.end(), [&](const auto& job) {
+            return job.second.first == cache && job.second.second == mesh.version();
+        });
+        if (running) {
+            continue;
+        }
+        const quint64 jobId = buildWorker_->start([mesh](const MR::ProgressCallback& cb) {
+            BooleanResult result;
+            if (!MR::reportProgress(cb, 0.0f)) {
+                result.errorMsg = BooleanOperator::kCanceledMsg;
+                return result;
+            }
+            mesh->getAABBTree();
+            result.mesh = mesh;
+            result.success = true;
+            return result;
+        }, QThread::LowestPriority);
+        treeJobs_[jobId] = {cache, mesh.version()};
+    }
+    
+    for (MeshProxy* proxy : {&targetProxy_, &cutterProxy_, &resultProxy_}) {
+        if (!proxy->needsBuild()) {
+            continue;
+        }
+        MeshHandle source = proxy->source();
+        proxy->startBuild(buildWorker_->start([source](const MR::ProgressCallback& cb) {
+            BooleanResult result;
+            result.mesh = MeshProxy::build(*source, MeshProxy::kFaceBudget, cb);
+            result.success = static_cast<bool>(result.mesh);
+            if (!result.success) {
+                result.errorMsg = BooleanOperator::kCanceledMsg;
+            }
+            return result;
+        }, QThread::LowestPriority));
+    }
+}
+
+void CutterVisualizer::onBuildFinished(quint64 jobId, std::shared_ptr<BooleanResult> result)
+{
+    // 任务编号与网格版本一一对应，网格已改变时编号已被忘记，结果被丢弃
+    auto tree = treeJobs_.find(jobId);
+    if (tree != treeJobs_.end()) {
+        RenderCache* cache = tree->second.first;
+        treeJobs_.erase(tree);
+        if (result->success) {
+            cache->setTree(result->mesh);
+        }
+        return;
+    }
+    
+    // 代理网格的树在构建代理时已建好，且代理发布前没有其他线程访问它
+    const std::pair<MeshProxy*, RenderCache*> proxies[] = {
+        {&targetProxy_, &targetProxyCache_}, {&cutterProxy_, &cutterProxyCache_}, {&resultProxy_, &resultProxyCache_}};
+    for (const auto& [proxy, cache] : proxies) {
+        if (proxy->finishBuild(jobId, result->mesh)) {
+            if (result->success) {
+                cache->setTree(result->mesh);
+                if (isInteracting()) {
+                    update();
+                }
+            }
+            return;
+        }
+    }
+}
+
+void CutterVisualizer::noteInteraction()
+{
+    interactionTimer_->start();
+}
+
+bool CutterVisualizer::isInteracting() const
+{
+    return isDragging_ || interactionTimer_->isActive();
+}
+
 void CutterVisualizer::setVisualMode(VisualMode mode)
 {
     visualMode_ = mode;
@@ -85,7 +252,7 @@ void CutterVisualizer::updateView()
 
 bool CutterVisualizer::saveResult(const QString& filename)
 {
-    if (!resultMesh_ || resultMesh_->points.empty())
+    if (resultMesh_.empty())
     {
         return false;
     }
@@ -105,9 +272,10 @@ void CutterVisualizer::paintEvent(QPaintEvent* event)
     float maxBound = 50.0f;
     bool hasMesh = false;
     
-    auto checkMesh = [&](const std::shared_ptr<MR::Mesh>& mesh) {
-        if (mesh && !mesh->points.empty()) {
-            auto bbox = mesh->computeBoundingBox();
+    // 包围盒按网格版本缓存，工具只变换缓存的包围盒
+    auto checkMesh = [&](const MeshHandle& mesh, const MR::AffineXf3f* xf) {
+        if (!mesh.empty()) {
+            auto bbox = xf ? MR::transformed(mesh.boundingBox(), *xf) : mesh.boundingBox();
             maxBound = std::max(maxBound, std::max({bbox.max.x - bbox.min.x,
                                                      bbox.max.y - bbox.min.y,
                                                      bbox.max.z - bbox.min.z}));
@@ -116,11 +284,11 @@ void CutterVisualizer::paintEvent(QPaintEvent* event)
     };
     
     if (visualMode_ == VisualMode::Original || visualMode_ == VisualMode::All)
-        checkMesh(targetMesh_);
+        checkMesh(targetMesh_, nullptr);
     if (visualMode_ == VisualMode::Cutter || visualMode_ == VisualMode::All)
-        checkMesh(cutterMesh_);
+        checkMesh(cutterMesh_, &cutterXf_);
     if (visualMode_ == VisualMode::Result || visualMode_ == VisualMode::All)
-        checkMesh(resultMesh_);
+        checkMesh(resultMesh_, nullptr);
     
     if (!hasMesh) {
         painter.drawText(rect(), Qt::AlignCenter, "No mesh loaded");
@@ -131,118 +299,59 @@ void CutterVisualizer::paintEvent(QPaintEvent* event)
     float baseScale = std::min(width(), height()) / (maxBound * 1.5f);
     float finalScale = baseScale * scale_;
     
-    // 绘制坐标轴
-    drawAxes(painter);
-    
-    // 渲染各个网格
-    if (visualMode_ == VisualMode::All || visualMode_ == VisualMode::Original) {
-        if (targetMesh_ && !targetMesh_->points.empty()) {
-            renderMesh(painter, *targetMesh_, QColor(100, 150, 255), 0.7f);
-        }
-    }
+    // 每个网格在各线程上分块光栅化到自己的渲染层，再按深度合成后一次绘制到窗口。
+    // 渲染层在网格、视图、位姿都不变时复用，只移动刀具时只重新光栅化刀具层
+    const RasterView view(rotX_, rotY_, std::min(width(), height()) / 150.0f * scale_,
+                          MR::Vector2f(width() / 2.0f + offset_.x(), height() / 2.0f + offset_.y()));
+    rasterizer_.resize(width(), height());
     
-    if (visualMode_ == VisualMode::All || visualMode_ == VisualMode::Cutter) {
-        if (cutterMesh_ && !cutterMesh_->points.empty()) {
-            renderMesh(painter, *cutterMesh_, QColor(255, 100, 100), 0.5f);
+    // 交互期间原网格的渲染层过期时绘制已就绪的简化代理，每帧耗时与原网格大小无关
+    const bool interacting = isInteracting();
+    std::vector<const RenderLayer*> layers;
+    auto drawLayer = [&](RenderLayer& layer, const MeshHandle& mesh, const MeshProxy& proxy, RenderCache& cache,
+                         RenderCache& proxyCache, const QColor& color, float opacity,
+                         const MR::AffineXf3f* xf) {
+        if (mesh.empty()) {
+            return;
         }
-    }
-    
-    if (visualMode_ == VisualMode::All || visualMode_ == VisualMode::Result) {
-        if (resultMesh_ && !resultMesh_->points.empty()) {
-            renderMesh(painter, *resultMesh_, QColor(100, 255, 150), 1.0f);
+        if (interacting && !rasterizer_.isCurrent(layer, mesh, view, color, opacity, xf)) {
+            const MeshHandle coarse = proxy.get();
+            if (coarse.version() != mesh.version()) {
+                rasterizer_.renderLayer(layer, coarse, proxyCache, view, color, opacity, xf);
+                layers.push_back(&layer);
+                return;
+            }
         }
-    }
-}
-
-void CutterVisualizer::renderMesh(QPainter& painter, const MR::Mesh& mesh, 
-                                   const QColor& color, float opacity)
-{
-    // 简单的正交投影渲染
-    float baseScale = std::min(width(), height()) / 150.0f * scale_;
-    QPoint center(width()/2 + offset_.x(), height()/2 + offset_.y());
-    
-    // 计算旋转矩阵
-    float cx = std::cos(rotX_);
-    float sx = std::sin(rotX_);
-    float cy = std::cos(rotY_);
-    float sy = std::sin(rotY_);
-    
-    auto rotate = [&](const Vec3& v) -> Vec3 {
-        // 绕X轴旋转
-        float y1 = v.y * cx - v.z * sx;
-        float z1 = v.y * sx + v.z * cx;
-        // 绕Y轴旋转
-        float x2 = v.x * cy + z1 * sy;
-        float z2 = -v.x * sy + z1 * cy;
-        return Vec3(x2, y1, z2);
-    };
-    
-    auto project = [&](const Vec3& v) -> QPoint {
-        Vec3 r = rotate(v);
-        return QPoint(center.x() + r.x * baseScale, 
-                      center.y() - r.y * baseScale);  // Y轴翻转
-    };
-    
-    // 简单的面片渲染
-    QPen pen(color);
-    pen.setWidth(1);
-    QColor fillColor = color;
-    fillColor.setAlphaF(opacity * 0.3f);
-    painter.setPen(pen);
-    
-    // 计算每个面的深度并排序（简单的画家算法）
-    struct FaceDepth {
-        MR::FaceId face;
-        float depth;
-        std::vector<QPoint> points;
+        rasterizer_.renderLayer(layer, mesh, cache, view, color, opacity, xf);
+        layers.push_back(&layer);
     };
-    std::vector<FaceDepth> faces;
     
-    for (auto f : mesh.topology.getValidFaces()) {
-        auto verts = mesh.topology.getTriVerts(f);
-        
-        Vec3 v0(mesh.points[verts[0]]);
-        Vec3 v1(mesh.points[verts[1]]);
-        Vec3 v2(mesh.points[verts[2]]);
-        
-        // 计算面中心深度
-        Vec3 center = (v0 + v1 + v2) * (1.0f/3.0f);
-        Vec3 rotated = rotate(center);
-        
-        FaceDepth fd;
-        fd.face = f;
-        fd.depth = rotated.z;
-        fd.points = {project(v0), project(v1), project(v2)};
-        faces.push_back(fd);
+    const bool showResult = visualMode_ == VisualMode::All || visualMode_ == VisualMode::Result;
+    if (showResult) {
+        drawLayer(resultLayer_, resultMesh_, resultProxy_, resultCache_, resultProxyCache_,
+                  QColor(100, 255, 150), 1.0f, nullptr);
     }
     
-    // 按深度排序（从远到近）
-    std::sort(faces.begin(), faces.end(), 
-              [](const FaceDepth& a, const FaceDepth& b) { return a.depth > b.depth; });
-    
-    // 绘制面
-    for (const auto& fd : faces) {
-        if (fd.points.size() >= 3) {
-            QPolygon polygon;
-            for (const auto& p : fd.points) {
-                polygon << p;
-            }
-            painter.setBrush(fillColor);
-            painter.drawPolygon(polygon);
+    // 原始模型与结果是同一网格时（如尚未切割），半透明层与不透明结果深度相同，不会显示，跳过；
+    // 单独显示时与结果共用三角形表
+    if (visualMode_ == VisualMode::All || visualMode_ == VisualMode::Original) {
+        const bool sameAsResult = !targetMesh_.empty() && targetMesh_.version() == resultMesh_.version();
+        if (!(sameAsResult && showResult)) {
+            drawLayer(targetLayer_, targetMesh_, targetProxy_, sameAsResult ? resultCache_ : targetCache_,
+                      targetProxyCache_, QColor(100, 150, 255), 0.7f, nullptr);
         }
     }
     
-    // 绘制边
-    painter.setBrush(Qt::NoBrush);
-    for (const auto& fd : faces) {
-        if (fd.points.size() >= 3) {
-            for (size_t i = 0; i < fd.points.size(); ++i) {
-                QPoint p1 = fd.points[i];
-                QPoint p2 = fd.points[(i+1) % fd.points.size()];
-                painter.drawLine(p1, p2);
-            }
-        }
+    if (visualMode_ == VisualMode::All || visualMode_ == VisualMode::Cutter) {
+        drawLayer(cutterLayer_, cutterMesh_, cutterProxy_, cutterCache_, cutterProxyCache_,
+                  QColor(255, 100, 100), 0.5f, &cutterXf_);
     }
+    
+    rasterizer_.composite(layers, palette().color(QPalette::Base));
+    painter.drawImage(0, 0, rasterizer_.image());
+    
+    // 绘制坐标轴
+    drawAxes(painter);
 }
 
 void CutterVisualizer::drawAxes(QPainter& painter)
@@ -329,6 +438,7 @@ void CutterVisualizer::mouseReleaseEvent(QMouseEvent* event)
     if (event->button() == Qt::LeftButton) {
 #endif
         isDragging_ = false;
+        update();  // 停止拖动：按原网格重绘
     }
 }
 
@@ -337,12 +447,6 @@ void CutterVisualizer::wheelEvent(QWheelEvent* event)
     float delta = event->angleDelta().y() / 120.0f;
     scale_ *= std::pow(1.1f, delta);
     scale_ = std::clamp(scale_, 0.1f, 10.0f);
+    noteInteraction();
     update();
 }
-
-void CutterVisualizer::projectVertex(const MR::Vector3f& vertex, QPoint& point)
-{
-    // 辅助函数，实际实现在 renderMesh 中
-    Q_UNUSED(vertex)
-    Q_UNUSED(point)
-}
@@ -8,8 +8,17 @@
 #pragma once
 
 #include <QWidget>
+#include <map>
 #include <memory>
 #include <MRMesh/MRMesh.h>
+#include <MRMesh/MRAffineXf3.h>
+#include "MeshHandle.h"
+#include "SoftwareRasterizer.h"
+#include "MeshProxy.h"
+
+class QTimer;
+class BooleanWorker;
+struct BooleanResult;
 
 // 前置声明 MeshLib 类
 namespace MR
@@ -43,19 +52,24 @@ public:
     ~CutterVisualizer();
 
     /**
-     * @brief 设置目标网格（从文件加载的模型）
+     * @brief 设置目标网格（从文件加载的模型），版本号不变时不重绘
      */
-    void setTargetMesh(const std::shared_ptr<MR::Mesh>& mesh);
+    void setTargetMesh(const MeshHandle& mesh);
     
     /**
      * @brief 设置切割工具网格（圆柱体）
      */
-    void setCutterMesh(const std::shared_ptr<MR::Mesh>& mesh);
+    void setCutterMesh(const MeshHandle& mesh);
+    
+    /**
+     * @brief 设置切割工具位姿，工具网格保持不变，绘制时才变换顶点
+     */
+    void setCutterTransform(const MR::AffineXf3f& xf);
     
     /**
      * @brief 设置切割结果网格
      */
-    void setResultMesh(const std::shared_ptr<MR::Mesh>& mesh);
+    void setResultMesh(const MeshHandle& mesh);
     
     /**
      * @brief 清除所有网格
@@ -82,7 +96,7 @@ public:
     /**
      * @brief 获取结果网格
      */
-    std::shared_ptr<MR::Mesh> getResultMesh() const { return resultMesh_; }
+    const MeshHandle& getResultMesh() const { return resultMesh_; }
 
 signals:
     /**
@@ -99,15 +113,45 @@ protected:
     void wheelEvent(QWheelEvent* event) override;
 
 private:
-    void renderMesh(QPainter& painter, const MR::Mesh& mesh, 
-                    const QColor& color, float opacity = 1.0f);
     void drawAxes(QPainter& painter);
-    void projectVertex(const MR::Vector3f& vertex, QPoint& point);
+    void requestProxy(MeshProxy& proxy, const MeshHandle& mesh);
+    void requestTree(RenderCache& cache);
+    void startBackgroundBuilds();
+    void onBuildFinished(quint64 jobId, std::shared_ptr<BooleanResult> result);
+    void noteInteraction();
+    bool isInteracting() const;
     
     // 网格数据
-    std::shared_ptr<MR::Mesh> targetMesh_;
-    std::shared_ptr<MR::Mesh> cutterMesh_;
-    std::shared_ptr<MR::Mesh> resultMesh_;
+    MeshHandle targetMesh_;
+    MeshHandle cutterMesh_;
+    MR::AffineXf3f cutterXf_;
+    MeshHandle resultMesh_;
+    
+    // 网格渲染：多线程分块光栅化到图像，每个网格保留自己的渲染缓存
+    SoftwareRasterizer rasterizer_;
+    RenderCache targetCache_;
+    RenderCache cutterCache_;
+    RenderCache resultCache_;
+    
+    // 各网格光栅化的结果，条件不变时跨帧复用，每帧只做合成
+    RenderLayer targetLayer_;
+    RenderLayer cutterLayer_;
+    RenderLayer resultLayer_;
+    
+    // 交互期间绘制的简化代理及其渲染缓存，停止交互一段时间后恢复绘制原网格
+    MeshProxy targetProxy_;
+    MeshProxy cutterProxy_;
+    MeshProxy resultProxy_;
+    RenderCache targetProxyCache_;
+    RenderCache cutterProxyCache_;
+    RenderCache resultProxyCache_;
+    QTimer* interactionTimer_ = nullptr;
+    
+    // 代理和原网格的 AABB 树在网格稳定一段时间后才以最低优先级在后台构建，
+    // 建好后随网格版本发布到渲染缓存
+    BooleanWorker* buildWorker_ = nullptr;
+    QTimer* buildTimer_ = nullptr;
+    std::map<quint64, std::pair<RenderCache*, uint64_t>> treeJobs_;  ///< 任务编号 -> (渲染缓存, 网格版本)
     
     // 显示模式
     VisualMode visualMode_ = VisualMode::All;
@@ -0,0 +1,1015 @@
+/**
+ * @file CylinderCutKernel.cpp
+ * @brief 解析圆柱切割内核实现
+ * 
+ * 所有判定都在刀具局部坐标系中进行：圆柱轴为 Z 轴，圆柱面在 XY 平面上的投影是圆。
+ * 与圆柱面相交的目标面都不竖直，因此可以在 XY 投影中处理：
+ * 1. 求目标边与圆的交点，每条边只求一次，相邻两个面共享同一个交点顶点
+ * 2. 每个面内落在三角形中的圆弧按弦高误差采样，各面的圆弧首尾相连成交线环
+ * 3. 面在圆外的部分用耳切法重新三角化，圆内的部分放入碎片
+ * 4. 交线环按高度排序，相邻两环之间（或环与端面之间）位于材料内的圆柱面即为孔壁
+ */
+
+#include "CylinderCutKernel.h"
+#include <MRMesh/MRMeshBuilder.h>
+#include <MRMesh/MRBitSetParallelFor.h>
+#include <MRMesh/MRParallelFor.h>
+#include <MRMesh/MRBox.h>
+#include <MRMesh/MRVector2.h>
+#include <MRMesh/MRVector3.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    constexpr double kTwoPi = 6.283185307179586;
+    
+    // 退化判定（顶点落在圆柱面或端面上、边与圆相切等）的相对容差
+    constexpr double kRelEps = 1e-5;
+    
+    double wrapAngle(double a)
+    {
+        a = std::fmod(a, kTwoPi);
+        return a < 0.0 ? a + kTwoPi : a;
+    }
+    
+    double cross2(const MR::Vector2d& a, const MR::Vector2d& b)
+    {
+        return a.x * b.y - a.y * b.x;
+    }
+    
+    /// 弦高误差不超过 tolerance 的最大圆心角
+    double angleStep(double radius, double tolerance)
+    {
+        const double t = std::clamp(tolerance / radius, 1e-6, 0.5);
+        return std::min(2.0 * std::acos(1.0 - t), kTwoPi / 16.0);
+    }
+    
+    /**
+     * @brief 目标边与圆柱面的交点（只保留高度在圆柱范围内的交点）
+     */
+    struct Crossing
+    {
+        double t = 0.0;          ///< 沿 EdgeId(无向边) 从起点量起的参数
+        double theta = 0.0;      ///< 圆周角 [0, 2π)
+        MR::Vector2d xy;         ///< 局部坐标下的投影
+        MR::VertId vert;         ///< 结果网格中的新顶点
+        int arcIn = -1;          ///< 沿 +θ 到达该点的圆弧
+        int arcOut = -1;         ///< 沿 +θ 离开该点的圆弧
+    };
+    
+    /**
+     * @brief 圆柱面在一个目标面内的一段交线（沿 +θ）
+     */
+    struct Arc
+    {
+        int face = -1;           ///< 所在面（touched 中的下标）
+        int from = -1;           ///< 起点交点，-1 表示整圆落在面内
+        int to = -1;             ///< 终点交点
+        double theta0 = 0.0;     ///< 起始角
+        double span = 0.0;       ///< 角度跨度 (0, 2π]
+        std::vector<MR::VertId> samples;   ///< 内部采样点（沿 +θ）
+        std::vector<double> sampleTheta;   ///< 采样点的圆周角
+    };
+    
+    /**
+     * @brief 被圆柱面穿过，或整个圆柱截面落在其中的目标面
+     */
+    struct TouchedFace
+    {
+        std::array<MR::EdgeId, 3> edges;     ///< 以该面为左侧的三条边，edges[i] 从 verts[i] 指向 verts[i + 1]
+        std::array<MR::VertId, 3> verts;
+        std::array<MR::Vector3d, 3> local;   ///< 顶点的刀具局部坐标
+        MR::Vector3d normal;                 ///< 局部坐标下的法向（未归一化）
+        double orient = 1.0;                 ///< XY 投影的环绕方向（+1 为逆时针，即法向朝 +Z）
+        bool hole = false;                   ///< 整个圆落在面内
+        std::vector<int> crossings;          ///< 三条边上的交点
+        std::vector<int> arcs;               ///< 面内的圆弧
+        
+        MR::Vector2d corner(int i) const
+        {
+            return MR::Vector2d(local[i].x, local[i].y);
+        }
+        
+        /// 面所在平面在 (x, y) 处的高度（面不竖直）
+        double zAt(double x, double y) const
+        {
+            return local[0].z - (normal.x * (x - local[0].x) + normal.y * (y - local[0].y)) / normal.z;
+        }
+        
+        /// XY 投影中 p 严格位于三角形内部
+        bool containsStrictly(const MR::Vector2d& p) const
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                const MR::Vector2d a = corner(i);
+                if (orient * cross2(corner((i + 1) % 3) - a, p - a) <= 0.0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        
+        /// XY 投影中以原点为圆心、半径为 radius 的圆严格位于三角形内部
+        bool containsCircle(double radius) const
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                const MR::Vector2d a = corner(i);
+                const MR::Vector2d edge = corner((i + 1) % 3) - a;
+                const double len = edge.length();
+                if (len == 0.0 || orient * cross2(edge, -a) <= radius * len)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+    
+    /**
+     * @brief 孔壁上的一圈边界（交线环或端面圆周），沿 +θ 排列
+     */
+    struct Ring
+    {
+        std::vector<MR::VertId> verts;
+        std::vector<double> theta;
+        bool up = false;         ///< 交线所在表面的法向朝 +Z（下方是材料）
+        double zRef = 0.0;       ///< θ = 0 处的高度，用于排序
+    };
+    
+    /**
+     * @brief 多边形顶点：结果网格中的顶点及其 XY 投影
+     */
+    struct PolyVert
+    {
+        MR::VertId v;
+        MR::Vector2d p;
+    };
+    
+    /**
+     * @brief 面边界上的点：角点或交点
+     */
+    struct BoundaryItem
+    {
+        PolyVert pv;
+        int crossing = -1;        ///< 交点编号，角点为 -1
+        bool insideAfter = false; ///< 沿边界经过该点之后是否在圆内
+    };
+    
+    /// 三角形质量：等边为 1，退化为 0
+    double triangleQuality(const MR::Vector2d& a, const MR::Vector2d& b, const MR::Vector2d& c)
+    {
+        const double area = 0.5 * std::abs(cross2(b - a, c - a));
+        const double sumSq = (b - a).lengthSq() + (c - b).lengthSq() + (a - c).lengthSq();
+        return sumSq > 0.0 ? 4.0 * std::sqrt(3.0) * area / sumSq : 0.0;
+    }
+    
+    /**
+     * @brief 耳切法三角化简单多边形（XY 投影），输出三角形保持多边形的环绕方向
+     * 
+     * 每一步在所有可切的耳中选质量最好的一个，减少细长三角形
+     * 
+     * @return 找不到可切的耳（多边形自交或退化）时返回 false
+     */
+    bool triangulatePolygon(const std::vector<PolyVert>& poly, MR::Triangulation& tris)
+    {
+        const size_t n = poly.size();
+        if (n < 3)
+        {
+            return false;
+        }
+        
+        double area2 = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            area2 += cross2(poly[i].p, poly[(i + 1) % n].p);
+        }
+        if (area2 == 0.0)
+        {
+            return false;
+        }
+        const double orient = area2 > 0.0 ? 1.0 : -1.0;
+        
+        std::vector<size_t> rest(n);
+        std::iota(rest.begin(), rest.end(), size_t(0));
+        while (rest.size() > 3)
+        {
+            const size_t m = rest.size();
+            size_t best = m;
+            double bestQuality = -1.0;
+            for (size_t k = 0; k < m; ++k)
+            {
+                const size_t i0 = rest[(k + m - 1) % m];
+                const size_t i1 = rest[k];
+                const size_t i2 = rest[(k + 1) % m];
+                const MR::Vector2d& a = poly[i0].p;
+                const MR::Vector2d& b = poly[i1].p;
+                const MR::Vector2d& c = poly[i2].p;
+                if (orient * cross2(b - a, c - b) <= 0.0)
+                {
+                    continue;
+                }
+                
+                // 其他顶点不能落在耳内，也不能落在新的对角线 c-a 上
+                bool blocked = false;
+                for (size_t j : rest)
+                {
+                    if (j == i0 || j == i1 || j == i2)
+                    {
+                        continue;
+                    }
+                    const MR::Vector2d& p = poly[j].p;
+                    if (orient * cross2(b - a, p - a) > 0.0 &&
+                        orient * cross2(c - b, p - b) > 0.0 &&
+                        orient * cross2(a - c, p - c) >= 0.0)
+                    {
+                        blocked = true;
+                        break;
+                    }
+                }
+                if (blocked)
+                {
+                    continue;
+                }
+                
+                const double quality = triangleQuality(a, b, c);
+                if (quality > bestQuality)
+                {
+                    bestQuality = quality;
+                    best = k;
+                }
+            }
+            
+            if (best == m)
+            {
+                return false;
+            }
+            tris.push_back({poly[rest[(best + m - 1) % m]].v, poly[rest[best]].v, poly[rest[(best + 1) % m]].v});
+            rest.erase(rest.begin() + best);
+        }
+        
+        const MR::Vector2d& a = poly[rest[0]].p;
+        const MR::Vector2d& b = poly[rest[1]].p;
+        const MR::Vector2d& c = poly[rest[2]].p;
+        if (orient * cross2(b - a, c - b) <= 0.0)
+        {
+            return false;
+        }
+        tris.push_back({poly[rest[0]].v, poly[rest[1]].v, poly[rest[2]].v});
+        return true;
+    }
+    
+    /// 三角形与平面 z = cap 的交线段是否进入半径为 radius 的圆盘
+    bool crossesCapDisk(const std::array<MR::Vector3d, 3>& tri, double cap, double radius)
+    {
+        MR::Vector2d ends[2];
+        int numEnds = 0;
+        for (int i = 0; i < 3 && numEnds < 2; ++i)
+        {
+            const MR::Vector3d& a = tri[i];
+            const MR::Vector3d& b = tri[(i + 1) % 3];
+            const double da = a.z - cap;
+            const double db = b.z - cap;
+            if ((da < 0.0) == (db < 0.0))
+            {
+                continue;
+            }
+            const double t = da / (da - db);
+            ends[numEnds++] = MR::Vector2d(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+        }
+        if (numEnds < 2)
+        {
+            return false;
+        }
+        
+        const MR::Vector2d d = ends[1] - ends[0];
+        const double len2 = d.lengthSq();
+        const double t = len2 > 0.0 ? std::clamp(-MR::dot(ends[0], d) / len2, 0.0, 1.0) : 0.0;
+        return (ends[0] + d * t).lengthSq() < radius * radius;
+    }
+    
+    /// 把环旋转到从最小圆周角开始，之后圆周角单调递增
+    void rotateToMinTheta(Ring& ring)
+    {
+        const auto first = std::min_element(ring.theta.begin(), ring.theta.end());
+        const auto shift = first - ring.theta.begin();
+        std::rotate(ring.theta.begin(), first, ring.theta.end());
+        std::rotate(ring.verts.begin(), ring.verts.begin() + shift, ring.verts.end());
+    }
+    
+    /**
+     * @brief 两圈边界之间的圆柱面带（lower 在下），法向指向圆柱轴（孔内）
+     * 
+     * 两圈按圆周角归并，每一步推进圆周角较小的一侧，共生成 m + n 个三角形
+     */
+    void zipRings(const Ring& lower, const Ring& upper, MR::Triangulation& tris)
+    {
+        const size_t m = lower.verts.size();
+        const size_t n = upper.verts.size();
+        auto angle = [](const Ring& ring, size_t k)
+        {
+            const size_t size = ring.theta.size();
+            return k < size ? ring.theta[k] : ring.theta[k - size] + kTwoPi;
+        };
+        
+        size_t i = 0;
+        size_t j = 0;
+        while (i < m || j < n)
+        {
+            const MR::VertId p = lower.verts[i % m];
+            const MR::VertId q = upper.verts[j % n];
+            if (j == n || (i < m && angle(lower, i + 1) <= angle(upper, j + 1)))
+            {
+                tris.push_back({p, q, lower.verts[(i + 1) % m]});
+                ++i;
+            }
+            else
+            {
+                tris.push_back({p, q, upper.verts[(j + 1) % n]});
+                ++j;
+            }
+        }
+    }
+}
+
+std::optional<BooleanResult> CylinderCutKernel::cut(const MR::Mesh& meshA, const CylinderParams& tool,
+                                                    const MR::AffineXf3f& toolXf, float chordTolerance)
+{
+    const double r = tool.getRadius();
+    const double h = 0.5 * tool.length;
+    if (r <= 0.0 || h <= 0.0 || meshA.points.empty())
+    {
+        return std::nullopt;
+    }
+    
+    const MR::MeshTopology& topology = meshA.topology;
+    const double eps = kRelEps * std::max(r, h);
+    const double step = angleStep(r, chordTolerance);
+    
+    // 1. 顶点变换到刀具局部坐标，选出包围盒与圆柱相交的面
+    const MR::AffineXf3f toLocal = toolXf.inverse();
+    MR::Vector<MR::Vector3d, MR::VertId> local(meshA.points.size());
+    MR::ParallelFor(size_t(0), meshA.points.size(), [&](size_t i)
+    {
+        const MR::VertId v(static_cast<int>(i));
+        local[v] = MR::Vector3d(toLocal(meshA.points[v]));
+    });
+    
+    const MR::Box3d toolBox(MR::Vector3d(-r - eps, -r - eps, -h - eps), MR::Vector3d(r + eps, r + eps, h + eps));
+    MR::FaceBitSet candidates(topology.faceSize());
+    MR::BitSetParallelFor(topology.getValidFaces(), [&](MR::FaceId f)
+    {
+        MR::Box3d box;
+        for (MR::VertId v : topology.getTriVerts(f))
+        {
+            box.include(local[v]);
+        }
+        if (box.intersects(toolBox))
+        {
+            candidates.set(f);
+        }
+    });
+    
+    // 结果保留 A 的全部顶点编号，新顶点追加在后面
+    MR::VertCoords points = meshA.points;
+    auto addPoint = [&](const MR::Vector3f& p)
+    {
+        const MR::VertId v(static_cast<int>(points.size()));
+        points.push_back(p);
+        return v;
+    };
+    auto toWorld = [&](double x, double y, double z)
+    {
+        return toolXf(MR::Vector3f(float(x), float(y), float(z)));
+    };
+    
+    // 2. 求边与圆的交点并给面分类
+    std::vector<Crossing> crossings;
+    std::unordered_map<int, std::vector<int>> edgeCrossings;  // 无向边 -> 边上的交点
+    std::vector<TouchedFace> touched;
+    MR::FaceBitSet removed(topology.faceSize());    // 被删除或重新三角化的面
+    MR::FaceBitSet insideFaces(topology.faceSize()); // 完全在圆柱内的面
+    
+    // 相切等无法稳定判定的情形返回 false
+    auto intersectEdge = [&](MR::UndirectedEdgeId ue)
+    {
+        std::vector<int>& hits = edgeCrossings[static_cast<int>(ue)];
+        const MR::EdgeId e(ue);
+        const MR::VertId o = topology.org(e);
+        const MR::VertId d = topology.dest(e);
+        const MR::Vector3d& p0 = local[o];
+        const MR::Vector3d& p1 = local[d];
+        const double dx = p1.x - p0.x;
+        const double dy = p1.y - p0.y;
+        const double a = dx * dx + dy * dy;
+        if (a <= eps * eps)
+        {
+            // 竖直边投影为一点，落在圆上的情形已由顶点检测排除
+            return true;
+        }
+        
+        const double b = p0.x * dx + p0.y * dy;
+        const double c = p0.x * p0.x + p0.y * p0.y - r * r;
+        const double disc = b * b - a * c;
+        if (disc < 0.0)
+        {
+            return true;
+        }
+        const double sq = std::sqrt(disc);
+        const bool tangent = 2.0 * sq / std::sqrt(a) < eps;
+        for (const double t : {(-b - sq) / a, (-b + sq) / a})
+        {
+            if (t <= 0.0 || t >= 1.0)
+            {
+                continue;
+            }
+            const double z = p0.z + t * (p1.z - p0.z);
+            if (std::abs(std::abs(z) - h) < eps)
+            {
+                return false;
+            }
+            if (std::abs(z) > h)
+            {
+                continue;
+            }
+            if (tangent)
+            {
+                return false;
+            }
+            
+            Crossing x;
+            x.t = t;
+            x.xy = MR::Vector2d(p0.x + t * dx, p0.y + t * dy);
+            x.theta = wrapAngle(std::atan2(x.xy.y, x.xy.x));
+            // 交点按 A 空间的原始坐标插值，精确落在原来的边上
+            x.vert = addPoint(meshA.points[o] + (meshA.points[d] - meshA.points[o]) * float(t));
+            hits.push_back(static_cast<int>(crossings.size()));
+            crossings.push_back(x);
+        }
+        return true;
+    };
+    
+    for (MR::FaceId f : candidates)
+    {
+        TouchedFace tf;
+        tf.edges[0] = topology.edgeWithLeft(f);
+        tf.edges[1] = topology.prev(tf.edges[0].sym());
+        tf.edges[2] = topology.prev(tf.edges[1].sym());
+        for (int i = 0; i < 3; ++i)
+        {
+            tf.verts[i] = topology.org(tf.edges[i]);
+            tf.local[i] = local[tf.verts[i]];
+        }
+        
+        // 顶点落在圆柱面或端面附近时无法稳定判定
+        int numInside = 0;
+        for (const MR::Vector3d& p : tf.local)
+        {
+            const double rho = std::hypot(p.x, p.y);
+            if (std::abs(rho - r) < eps && std::abs(p.z) < h + eps)
+            {
+                return std::nullopt;
+            }
+            if (std::abs(std::abs(p.z) - h) < eps && rho < r + eps)
+            {
+                return std::nullopt;
+            }
+            if (rho < r && std::abs(p.z) < h)
+            {
+                ++numInside;
+            }
+        }
+        
+        // 表面穿过端面：不是钻孔情形
+        if (crossesCapDisk(tf.local, -h, r + eps) || crossesCapDisk(tf.local, h, r + eps))
+        {
+            return std::nullopt;
+        }
+        
+        for (MR::EdgeId e : tf.edges)
+        {
+            const int ue = static_cast<int>(e.undirected());
+            if (!edgeCrossings.count(ue) && !intersectEdge(e.undirected()))
+            {
+                return std::nullopt;
+            }
+            const std::vector<int>& hits = edgeCrossings[ue];
+            tf.crossings.insert(tf.crossings.end(), hits.begin(), hits.end());
+        }
+        
+        tf.normal = MR::cross(tf.local[1] - tf.local[0], tf.local[2] - tf.local[0]);
+        tf.orient = tf.normal.z > 0.0 ? 1.0 : -1.0;
+        const bool vertical = std::abs(tf.normal.z) <= kRelEps * tf.normal.length();
+        
+        if (!tf.crossings.empty())
+        {
+            // 与圆柱轴平行的面上交线是竖直线段，无法在投影中处理
+            if (vertical)
+            {
+                return std::nullopt;
+            }
+            removed.set(f);
+            touched.push_back(std::move(tf));
+        }
+        else if (numInside == 3)
+        {
+            removed.set(f);
+            insideFaces.set(f);
+        }
+        else if (numInside != 0)
+        {
+            return std::nullopt;
+        }
+        else if (!vertical && tf.containsCircle(r + eps))
+        {
+            // 整个截面落在面内：面在圆上的高度范围为 z(0, 0) ± r·|∇z|
+            const double zc = tf.zAt(0.0, 0.0);
+            const double dz = r * std::hypot(tf.normal.x, tf.normal.y) / std::abs(tf.normal.z);
+            if (zc - dz > -h + eps && zc + dz < h - eps)
+            {
+                tf.hole = true;
+                removed.set(f);
+                touched.push_back(std::move(tf));
+            }
+            else if (zc - dz < h + eps && zc + dz > -h - eps)
+            {
+                return std::nullopt;
+            }
+        }
+    }
+    
+    // 3. 每个面内的圆弧：交点按圆周角排序，相邻两点之间的圆弧中点落在三角形内时即为一段交线
+    std::vector<Arc> arcs;
+    auto sampleArc = [&](Arc& arc, const TouchedFace& tf, int first, int last, int numSegments)
+    {
+        for (int j = first; j <= last; ++j)
+        {
+            const double theta = arc.theta0 + arc.span * j / numSegments;
+            const double x = r * std::cos(theta);
+            const double y = r * std::sin(theta);
+            arc.samples.push_back(addPoint(toWorld(x, y, tf.zAt(x, y))));
+            arc.sampleTheta.push_back(wrapAngle(theta));
+        }
+    };
+    
+    for (int fi = 0; fi < static_cast<int>(touched.size()); ++fi)
+    {
+        TouchedFace& tf = touched[fi];
+        if (tf.hole)
+        {
+            Arc arc;
+            arc.face = fi;
+            arc.span = kTwoPi;
+            const int numSegments = std::max(8, static_cast<int>(std::ceil(kTwoPi / step)));
+            sampleArc(arc, tf, 0, numSegments - 1, numSegments);
+            tf.arcs.push_back(static_cast<int>(arcs.size()));
+            arcs.push_back(std::move(arc));
+            continue;
+        }
+        
+        std::vector<int>& xs = tf.crossings;
+        if (xs.size() % 2 != 0)
+        {
+            return std::nullopt;
+        }
+        std::sort(xs.begin(), xs.end(), [&](int a, int b) { return crossings[a].theta < crossings[b].theta; });
+        
+        for (size_t i = 0; i < xs.size(); ++i)
+        {
+            Arc arc;
+            arc.face = fi;
+            arc.from = xs[i];
+            arc.to = xs[(i + 1) % xs.size()];
+            arc.theta0 = crossings[arc.from].theta;
+            arc.span = wrapAngle(crossings[arc.to].theta - arc.theta0);
+            if (arc.span <= kRelEps)
+            {
+                return std::nullopt;
+            }
+            const double mid = arc.theta0 + 0.5 * arc.span;
+            if (!tf.containsStrictly(MR::Vector2d(r * std::cos(mid), r * std::sin(mid))))
+            {
+                continue;
+            }
+            
+            // 每个交点只能是一段圆弧的起点和另一个面中一段圆弧的终点
+            if (crossings[arc.from].arcOut >= 0 || crossings[arc.to].arcIn >= 0)
+            {
+                return std::nullopt;
+            }
+            crossings[arc.from].arcOut = static_cast<int>(arcs.size());
+            crossings[arc.to].arcIn = static_cast<int>(arcs.size());
+            
+            // 至少取一个内部采样点，避免弦与三角形的边重合
+            const int numSegments = std::max(2, static_cast<int>(std::ceil(arc.span / step)));
+            sampleArc(arc, tf, 1, numSegments - 1, numSegments);
+            tf.arcs.push_back(static_cast<int>(arcs.size()));
+            arcs.push_back(std::move(arc));
+        }
+        
+        if (tf.arcs.size() * 2 != xs.size())
+        {
+            return std::nullopt;
+        }
+    }
+    
+    for (const Crossing& x : crossings)
+    {
+        if (x.arcIn < 0 || x.arcOut < 0 || arcs[x.arcIn].face == arcs[x.arcOut].face)
+        {
+            return std::nullopt;
+        }
+    }
+    
+    // 4. 圆弧首尾相连成交线环，每个环必须绕轴恰好一周且所在表面朝向一致
+    std::vector<Ring> rings;
+    std::vector<char> arcVisited(arcs.size(), 0);
+    for (size_t start = 0; start < arcs.size(); ++start)
+    {
+        if (arcVisited[start])
+        {
+            continue;
+        }
+        
+        Ring ring;
+        const double orient = touched[arcs[start].face].orient;
+        double total = 0.0;
+        size_t cur = start;
+        do
+        {
+            if (arcVisited[cur])
+            {
+                return std::nullopt;
+            }
+            arcVisited[cur] = 1;
+            
+            const Arc& arc = arcs[cur];
+            const TouchedFace& tf = touched[arc.face];
+            if (tf.orient != orient)
+            {
+                return std::nullopt;
+            }
+            if (arc.from >= 0)
+            {
+                ring.verts.push_back(crossings[arc.from].vert);
+                ring.theta.push_back(crossings[arc.from].theta);
+            }
+            ring.verts.insert(ring.verts.end(), arc.samples.begin(), arc.samples.end());
+            ring.theta.insert(ring.theta.end(), arc.sampleTheta.begin(), arc.sampleTheta.end());
+            if (wrapAngle(-arc.theta0) <= arc.span)
+            {
+                ring.zRef = tf.zAt(r, 0.0);
+            }
+            total += arc.span;
+            
+            if (arc.to < 0)
+            {
+                break;
+            }
+            cur = static_cast<size_t>(crossings[arc.to].arcOut);
+        }
+        while (cur != start);
+        
+        if (std::abs(total - kTwoPi) > 1e-3)
+        {
+            return std::nullopt;
+        }
+        ring.up = orient > 0.0;
+        rotateToMinTheta(ring);
+        rings.push_back(std::move(ring));
+    }
+    
+    if (rings.empty())
+    {
+        return std::nullopt;
+    }
+    
+    // 5. 孔壁：由下往上，朝上的表面离开材料、朝下的表面进入材料，两者必须交替
+    std::sort(rings.begin(), rings.end(), [](const Ring& a, const Ring& b) { return a.zRef < b.zRef; });
+    bool inMaterial = rings.front().up;
+    const bool bottomCap = inMaterial;
+    for (const Ring& ring : rings)
+    {
+        if (ring.up != inMaterial)
+        {
+            return std::nullopt;
+        }
+        inMaterial = !inMaterial;
+    }
+    const bool topCap = inMaterial;
+    
+    MR::Triangulation wallTris;
+    const int rimSegments = std::max(8, static_cast<int>(std::ceil(kTwoPi / step)));
+    auto makeRim = [&](double z)
+    {
+        Ring rim;
+        for (int j = 0; j < rimSegments; ++j)
+        {
+            const double theta = kTwoPi * j / rimSegments;
+            rim.verts.push_back(addPoint(toWorld(r * std::cos(theta), r * std::sin(theta), z)));
+            rim.theta.push_back(theta);
+        }
+        return rim;
+    };
+    // 端面：材料在下方（底面）时法向朝 +Z，在上方（顶面）时朝 -Z
+    auto addCap = [&](const Ring& rim, double z, bool bottom)
+    {
+        const MR::VertId center = addPoint(toWorld(0.0, 0.0, z));
+        for (int j = 0; j < rimSegments; ++j)
+        {
+            const MR::VertId a = rim.verts[j];
+            const MR::VertId b = rim.verts[(j + 1) % rimSegments];
+            if (bottom)
+            {
+                wallTris.push_back({center, a, b});
+            }
+            else
+            {
+                wallTris.push_back({center, b, a});
+            }
+        }
+    };
+    
+    if (bottomCap)
+    {
+        const Ring rim = makeRim(-h);
+        zipRings(rim, rings.front(), wallTris);
+        addCap(rim, -h, true);
+    }
+    for (size_t i = 0; i + 1 < rings.size(); ++i)
+    {
+        if (!rings[i].up)
+        {
+            zipRings(rings[i], rings[i + 1], wallTris);
+        }
+    }
+    if (topCap)
+    {
+        const Ring rim = makeRim(h);
+        zipRings(rings.back(), rim, wallTris);
+        addCap(rim, h, false);
+    }
+    
+    // 6. 重新三角化被穿过的面：圆外部分留在结果中，圆内部分放入碎片
+    MR::Triangulation newTris;
+    MR::Triangulation pieceTris;
+    auto samplePoint = [&](const Arc& arc, size_t j)
+    {
+        return PolyVert{arc.samples[j], MR::Vector2d(r * std::cos(arc.sampleTheta[j]), r * std::sin(arc.sampleTheta[j]))};
+    };
+    
+    for (int fi = 0; fi < static_cast<int>(touched.size()); ++fi)
+    {
+        const TouchedFace& tf = touched[fi];
+        
+        if (tf.hole)
+        {
+            const Arc& arc = arcs[tf.arcs.front()];
+            const int n = static_cast<int>(arc.samples.size());
+            const int dir = tf.orient > 0.0 ? 1 : -1;
+            
+            // 圆内部分：按面的环绕方向排列的采样点
+            std::vector<PolyVert> disk;
+            for (int j = 0; j < n; ++j)
+            {
+                disk.push_back(samplePoint(arc, dir > 0 ? j : n - 1 - j));
+            }
+            if (!triangulatePolygon(disk, pieceTris))
+            {
+                return std::nullopt;
+            }
+            
+            // 圆外部分：每个角点连到圆周角最接近且可见的采样点，分成三个扇区
+            std::array<int, 3> nearest;
+            for (int i = 0; i < 3; ++i)
+            {
+                const MR::Vector2d corner = tf.corner(i);
+                const double cornerAngle = std::atan2(corner.y, corner.x);
+                nearest[i] = -1;
+                double bestDiff = kTwoPi;
+                for (int j = 0; j < n; ++j)
+                {
+                    // 线段上离圆心最近的点是采样点本身时，线段不会进入圆内
+                    const MR::Vector2d s = samplePoint(arc, j).p;
+                    if (MR::dot(corner - s, s) < 0.0)
+                    {
+                        continue;
+                    }
+                    const double diff = wrapAngle(arc.sampleTheta[j] - cornerAngle);
+                    const double absDiff = std::min(diff, kTwoPi - diff);
+                    if (absDiff < bestDiff)
+                    {
+                        bestDiff = absDiff;
+                        nearest[i] = j;
+                    }
+                }
+                if (nearest[i] < 0)
+                {
+                    return std::nullopt;
+                }
+            }
+            
+            int total = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                total += ((nearest[(i + 1) % 3] - nearest[i]) * dir % n + n) % n;
+            }
+            if (total != n)
+            {
+                return std::nullopt;
+            }
+            
+            for (int i = 0; i < 3; ++i)
+            {
+                const int next = (i + 1) % 3;
+                std::vector<PolyVert> sector = {{tf.verts[i], tf.corner(i)}, {tf.verts[next], tf.corner(next)}};
+                for (int j = nearest[next]; ; j = ((j - dir) % n + n) % n)
+                {
+                    sector.push_back(samplePoint(arc, j));
+                    if (j == nearest[i])
+                    {
+                        break;
+                    }
+                }
+                if (!triangulatePolygon(sector, newTris))
+                {
+                    return std::nullopt;
+                }
+            }
+            continue;
+        }
+        
+        // 面边界：角点和按顺序插入的交点，记录经过每个点之后是否在圆内
+        std::vector<BoundaryItem> boundary;
+        for (int i = 0; i < 3; ++i)
+        {
+            const MR::Vector2d a = tf.corner(i);
+            bool inside = a.lengthSq() < r * r;
+            boundary.push_back({{tf.verts[i], a}, -1, inside});
+            
+            const MR::EdgeId e = tf.edges[i];
+            std::vector<std::pair<double, int>> onEdge;
+            for (int x : edgeCrossings[static_cast<int>(e.undirected())])
+            {
+                onEdge.push_back({e.even() ? crossings[x].t : 1.0 - crossings[x].t, x});
+            }
+            std::sort(onEdge.begin(), onEdge.end());
+            for (const auto& [t, x] : onEdge)
+            {
+                inside = !inside;
+                boundary.push_back({{crossings[x].vert, crossings[x].xy}, x, inside});
+            }
+            if (inside != (tf.corner((i + 1) % 3).lengthSq() < r * r))
+            {
+                return std::nullopt;
+            }
+        }
+        
+        auto boundaryIndex = [&](int x)
+        {
+            for (size_t k = 0; k < boundary.size(); ++k)
+            {
+                if (boundary[k].crossing == x)
+                {
+                    return k;
+                }
+            }
+            return boundary.size();
+        };
+        
+        // 从离开（outside）或进入圆的交点出发，沿面边界走到下一个交点，
+        // 再沿面内圆弧走到圆弧的另一端，直到回到出发点
+        auto tracePolygons = [&](bool outside, MR::Triangulation& out)
+        {
+            const size_t n = boundary.size();
+            std::vector<char> used(n, 0);
+            for (size_t start = 0; start < n; ++start)
+            {
+                if (boundary[start].crossing < 0 || boundary[start].insideAfter == outside || used[start])
+                {
+                    continue;
+                }
+                
+                std::vector<PolyVert> poly;
+                size_t idx = start;
+                while (true)
+                {
+                    used[idx] = 1;
+                    poly.push_back(boundary[idx].pv);
+                    size_t k = (idx + 1) % n;
+                    while (boundary[k].crossing < 0)
+                    {
+                        poly.push_back(boundary[k].pv);
+                        k = (k + 1) % n;
+                    }
+                    poly.push_back(boundary[k].pv);
+                    
+                    const Crossing& x = crossings[boundary[k].crossing];
+                    const Arc& arc = arcs[arcs[x.arcIn].face == fi ? x.arcIn : x.arcOut];
+                    int other = -1;
+                    if (arc.from == boundary[k].crossing)
+                    {
+                        for (size_t j = 0; j < arc.samples.size(); ++j)
+                        {
+                            poly.push_back(samplePoint(arc, j));
+                        }
+                        other = arc.to;
+                    }
+                    else
+                    {
+                        for (size_t j = arc.samples.size(); j-- > 0;)
+                        {
+                            poly.push_back(samplePoint(arc, j));
+                        }
+                        other = arc.from;
+                    }
+                    
+                    idx = boundaryIndex(other);
+                    if (idx == start)
+                    {
+                        break;
+                    }
+                    if (idx == n || used[idx] || poly.size() > 4 * n + arcs.size() * 64)
+                    {
+                        return false;
+                    }
+                }
+                
+                if (!triangulatePolygon(poly, out))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        
+        if (!tracePolygons(true, newTris) || !tracePolygons(false, pieceTris))
+        {
+            return std::nullopt;
+        }
+    }
+    
+    // 7. 组装结果：未改动的面保持原顶点，加上重新三角化的面和孔壁
+    MR::Triangulation resultTris;
+    for (MR::FaceId f : topology.getValidFaces())
+    {
+        if (!removed.test(f))
+        {
+            resultTris.push_back(topology.getTriVerts(f));
+        }
+    }
+    const int numKept = static_cast<int>(resultTris.size());
+    resultTris.vec_.insert(resultTris.vec_.end(), newTris.vec_.begin(), newTris.vec_.end());
+    resultTris.vec_.insert(resultTris.vec_.end(), wallTris.vec_.begin(), wallTris.vec_.end());
+    
+    // 碎片：圆柱内的原有面、被穿过面的圆内部分，以及反向的孔壁
+    for (MR::FaceId f : insideFaces)
+    {
+        pieceTris.push_back(topology.getTriVerts(f));
+    }
+    for (const MR::ThreeVertIds& t : wallTris)
+    {
+        pieceTris.push_back({t[0], t[2], t[1]});
+    }
+    
+    MR::Mesh piece;
+    MR::VertMap pieceVerts(points.size());
+    for (MR::ThreeVertIds& t : pieceTris)
+    {
+        for (MR::VertId& v : t)
+        {
+            if (!pieceVerts[v])
+            {
+                pieceVerts[v] = MR::VertId(static_cast<int>(piece.points.size()));
+                piece.points.push_back(points[v]);
+            }
+            v = pieceVerts[v];
+        }
+    }
+    piece.topology = MR::MeshBuilder::fromTriangles(pieceTris);
+    
+    MR::Mesh drilled;
+    drilled.topology = MR::MeshBuilder::fromTriangles(resultTris);
+    drilled.points = std::move(points);
+    
+    BooleanResult result;
+    // 面按三角形的顺序编号：保留的面在前，重新三角化的面和孔壁在后
+    result.removedFaces = std::move(removed);
+    result.addedFaces.resize(drilled.topology.faceSize());
+    for (int f = numKept; f < static_cast<int>(drilled.topology.faceSize()); ++f)
+    {
+        result.addedFaces.set(MR::FaceId(f));
+    }
+    result.mesh = std::move(drilled);
+    result.cutPiece = std::move(piece);
+    result.profile.numIntersections = crossings.size();
+    result.profile.numContours = rings.size();
+    result.success = true;
+    return result;
+}
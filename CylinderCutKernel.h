@@ -0,0 +1,36 @@
+/**
+ * @file CylinderCutKernel.h
+ * @brief 解析圆柱切割内核
+ * 
+ * 刀具总是圆柱体：直接用隐式圆柱面 x² + y² = r² 和两个端面裁剪目标三角形，
+ * 再按弦高误差三角化孔壁，不需要把目标的每个三角形与刀具的三角网格求交。
+ * 孔壁顶点精确落在圆柱面上，与通用布尔运算相比也少了多边形刀具带来的细长三角形
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRAffineXf3.h>
+#include <optional>
+#include "BooleanOperator.h"
+#include "CylinderGenerator.h"
+
+namespace CylinderCutKernel
+{
+    /**
+     * @brief 从目标网格中切去圆柱（钻孔）
+     * 
+     * 只处理钻孔情形：目标表面只与圆柱侧面相交（不穿过端面），
+     * 每条交线绕圆柱轴恰好一周，且与交线相交的面不平行于圆柱轴。
+     * 其余情形以及顶点恰好落在圆柱面上等退化情形返回 std::nullopt，由通用布尔运算处理
+     * 
+     * @param meshA 目标网格（或窗口子网格），结果保留其全部顶点编号
+     * @param tool 圆柱参数（规范位置：轴为 Z 轴，中心在原点，与 CylinderGenerator::generate 一致）
+     * @param toolXf 圆柱位姿（规范位置到 meshA 空间的刚体变换）
+     * @param chordTolerance 孔壁弦高误差 (mm)
+     * @return mesh 为剩余部分，cutPiece 为碎片，profile 中记录交点数和交线环数；
+     *         removedFaces / addedFaces 为删除和新增的面（保留的面重新编号，windowed 为 false）
+     */
+    std::optional<BooleanResult> cut(const MR::Mesh& meshA, const CylinderParams& tool,
+                                     const MR::AffineXf3f& toolXf, float chordTolerance);
+}
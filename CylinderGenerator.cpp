@@ -9,8 +9,12 @@
 #include <MRMesh/MRVector3.h>
 #include <MRMesh/MRAffineXf3.h>
 #include <MRMesh/MRMatrix3.h>
+#include <MRMesh/MRConvexHull.h>
+#include <MRMesh/MRMeshBoolean.h>
+#include <tbb/parallel_invoke.h>
 #include <cmath>
 #include <algorithm>
+#include <functional>
 
 CylinderGenerator::CylinderGenerator()
 {
@@ -146,3 +150,107 @@ MR::Mesh CylinderGenerator::generateAt(const MR::Vector3f& position,
     mesh.transform(transform);
     return mesh;
 }
+
+MR::Mesh CylinderGenerator::generateSweep(const std::vector<MR::Vector3f>& path,
+                                          const MR::Vector3f& direction) const
+{
+    if (path.empty())
+    {
+        return MR::Mesh();
+    }
+    
+    // 每段的扫掠体：两端圆柱体顶点的凸包
+    std::vector<MR::Mesh> segments;
+    segments.reserve(path.size());
+    
+    const MR::Mesh startCylinder = generateAt(path.front(), direction);
+    if (startCylinder.points.empty())
+    {
+        return MR::Mesh();
+    }
+    
+    for (size_t i = 0; i + 1 < path.size(); ++i)
+    {
+        const MR::Vector3f offset = path[i + 1] - path[i];
+        if (offset.lengthSq() < 1e-12f)
+        {
+            continue;
+        }
+        
+        // 起点圆柱体平移到该段的两个端点
+        const MR::Vector3f start = path[i] - path.front();
+        MR::VertCoords hullPoints;
+        hullPoints.reserve(startCylinder.points.size() * 2);
+        for (const auto& p : startCylinder.points)
+        {
+            hullPoints.push_back(p + start);
+            hullPoints.push_back(p + start + offset);
+        }
+        
+        MR::VertBitSet validPoints(hullPoints.size());
+        validPoints.set();
+        segments.push_back(MR::makeConvexHull(hullPoints, validPoints));
+    }
+    
+    if (segments.empty())
+    {
+        return startCylinder;
+    }
+    
+    // 相邻段共享端部圆柱体，用并行归约树求并集
+    std::function<MR::Mesh(size_t, size_t)> unite = [&](size_t begin, size_t end) -> MR::Mesh
+    {
+        if (end - begin == 1)
+        {
+            return std::move(segments[begin]);
+        }
+        
+        const size_t mid = begin + (end - begin) / 2;
+        MR::Mesh left, right;
+        tbb::parallel_invoke(
+            [&]() { left = unite(begin, mid); },
+            [&]() { right = unite(mid, end); });
+        if (left.points.empty() || right.points.empty())
+        {
+            return MR::Mesh();
+        }
+        
+        // 两部分互相重叠，求并失败时不能简单拼接（得到自相交的壳，差集结果不可靠），整体失败
+        MR::BooleanResult united = MR::boolean(left, right, MR::BooleanOperation::Union);
+        if (!united.valid())
+        {
+            return MR::Mesh();
+        }
+        return std::move(united.mesh);
+    };
+    
+    return unite(0, segments.size());
+}
+
+std::vector<MR::Vector3f> CylinderGenerator::arcPath(const MR::Vector3f& center, float radius,
+                                                     float startAngle, float endAngle,
+                                                     float chordTolerance)
+{
+    std::vector<MR::Vector3f> points;
+    if (radius <= 0)
+    {
+        points.push_back(center);
+        return points;
+    }
+    
+    // 弦高 h = r * (1 - cos(θ/2))，由误差反求每段最大圆心角
+    const float tolerance = std::clamp(chordTolerance, 1e-6f, radius);
+    const float maxStep = 2.0f * std::acos(1.0f - tolerance / radius);
+    const float sweep = endAngle - startAngle;
+    const int steps = std::max(1, static_cast<int>(std::ceil(std::abs(sweep) / maxStep)));
+    
+    points.reserve(steps + 1);
+    for (int i = 0; i <= steps; ++i)
+    {
+        const float angle = startAngle + sweep * i / steps;
+        points.emplace_back(center.x + radius * std::cos(angle),
+                            center.y + radius * std::sin(angle),
+                            center.z);
+    }
+    return points;
+}
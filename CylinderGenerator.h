@@ -10,6 +10,7 @@
 #include <MRMesh/MRMesh.h>
 #include <MRMesh/MRVector3.h>
 #include <memory>
+#include <vector>
 
 /**
  * @brief 圆柱体参数结构
@@ -57,6 +58,32 @@ public:
     MR::Mesh generateAt(const MR::Vector3f& position, 
                         const MR::Vector3f& direction = MR::Vector3f(0, 0, 1)) const;
     
+    /**
+     * @brief 生成圆柱体沿折线路径平移扫过的体积（单个封闭网格）
+     * 
+     * 凸体沿直线段平移扫过的体积等于两端凸体的凸包，
+     * 每段求凸包后再求并集，路径中的圆弧应先用 arcPath 离散
+     * 
+     * @param path 圆柱体中心依次经过的点
+     * @param direction 圆柱体轴向方向（沿路径保持不变）
+     * @return 扫掠体网格，路径为空或相邻段求并失败时返回空mesh
+     */
+    MR::Mesh generateSweep(const std::vector<MR::Vector3f>& path,
+                           const MR::Vector3f& direction = MR::Vector3f(0, 0, 1)) const;
+    
+    /**
+     * @brief 把 XY 平面内的圆弧离散为折线点
+     * @param center 圆心（Z 坐标即圆弧高度）
+     * @param radius 半径
+     * @param startAngle 起始角（弧度）
+     * @param endAngle 终止角（弧度），小于起始角时顺时针
+     * @param chordTolerance 弦高误差 (mm)
+     * @return 包含两端点的折线点
+     */
+    static std::vector<MR::Vector3f> arcPath(const MR::Vector3f& center, float radius,
+                                             float startAngle, float endAngle,
+                                             float chordTolerance = 0.01f);
+    
 private:
     CylinderParams params_;
 };
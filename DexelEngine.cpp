@@ -0,0 +1,721 @@
+/**
+ * @file DexelEngine.cpp
+ * @brief 三向 Dexel 材料去除引擎实现
+ */
+
+#include "DexelEngine.h"
+#include <MRMesh/MRMeshIntersect.h>
+#include <MRMesh/MRLine.h>
+#include <MRMesh/MRVector2.h>
+#include <MRMesh/MRParallelFor.h>
+#include <MRMesh/MRMeshBuilder.h>
+#include <MRVoxels/MRMarchingCubes.h>
+#include <MRVoxels/MRVoxelsVolume.h>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    constexpr float kEps = 1e-9f;
+    
+    // 网格分块的边长（格子数）
+    constexpr int kBlockCells = 32;
+    
+    // 射线小块的边长（射线数）
+    constexpr int kTileRays = 16;
+    
+    /**
+     * @brief 一维闭区间，lo > hi 表示空
+     */
+    struct Range
+    {
+        float lo = 1.0f;
+        float hi = 0.0f;
+        
+        bool empty() const { return lo > hi; }
+        
+        void include(const Range& r)
+        {
+            if (r.empty())
+                return;
+            if (empty())
+            {
+                *this = r;
+                return;
+            }
+            lo = std::min(lo, r.lo);
+            hi = std::max(hi, r.hi);
+        }
+        
+        void intersect(const Range& r)
+        {
+            lo = std::max(lo, r.lo);
+            hi = std::min(hi, r.hi);
+        }
+    };
+    
+    /**
+     * @brief 求满足 lo <= a * x + b <= hi 的 x
+     */
+    Range solveLinear(float a, float b, float lo, float hi)
+    {
+        if (std::abs(a) < kEps)
+        {
+            return (b >= lo && b <= hi) ? Range{-FLT_MAX, FLT_MAX} : Range{};
+        }
+        float x0 = (lo - b) / a;
+        float x1 = (hi - b) / a;
+        if (x0 > x1)
+            std::swap(x0, x1);
+        return Range{x0, x1};
+    }
+    
+    /**
+     * @brief 平面胶囊体（圆盘沿 p0-p1 扫过的区域）与直线 y = c 的截线在 x 上的范围
+     * 
+     * 胶囊体是凸集，截线等于两端圆盘和中间矩形各自截线的包络
+     */
+    Range capsuleSection(const MR::Vector2f& p0, const MR::Vector2f& p1, float r, float c)
+    {
+        Range result;
+        
+        for (const auto& p : {p0, p1})
+        {
+            const float dy = c - p.y;
+            if (std::abs(dy) <= r)
+            {
+                const float half = std::sqrt(r * r - dy * dy);
+                result.include(Range{p.x - half, p.x + half});
+            }
+        }
+        
+        const MR::Vector2f d = p1 - p0;
+        const float len2 = MR::dot(d, d);
+        if (len2 > kEps)
+        {
+            // 矩形：0 <= (P - p0)·d <= |d|^2 且 |(P - p0)·n| <= r
+            const float len = std::sqrt(len2);
+            const MR::Vector2f n(-d.y / len, d.x / len);
+            Range rect = solveLinear(d.x, (c - p0.y) * d.y - p0.x * d.x, 0.0f, len2);
+            rect.intersect(solveLinear(n.x, (c - p0.y) * n.y - p0.x * n.x, -r, r));
+            result.include(rect);
+        }
+        
+        return result;
+    }
+    
+    /**
+     * @brief 射线上点 t 到区间边界的有符号距离（内部为负）
+     */
+    float signedDistance(const std::vector<DexelInterval>* ray, float t, float maxDist)
+    {
+        float dist = maxDist;
+        bool inside = false;
+        if (!ray)
+            return dist;
+        for (const auto& iv : *ray)
+        {
+            if (t >= iv.start && t <= iv.end)
+                inside = true;
+            dist = std::min({dist, std::abs(t - iv.start), std::abs(t - iv.end)});
+        }
+        return inside ? -dist : dist;
+    }
+}
+
+DexelEngine::DexelEngine(float spacing)
+    : spacing_(spacing)
+{
+}
+
+void DexelEngine::setSpacing(float spacing)
+{
+    if (spacing != spacing_)
+    {
+        spacing_ = spacing;
+        reset();
+    }
+}
+
+void DexelEngine::reset()
+{
+    for (auto& rays : rays_)
+    {
+        rays.clear();
+    }
+    blockMeshes_.clear();
+    dirtyBlocks_.clear();
+    meshCache_.reset();
+    moveCount_ = 0;
+}
+
+void DexelEngine::allocate(const MR::Box3f& box)
+{
+    // 四周各留一圈空格点，保证表面完全位于格点内部
+    origin_ = box.min - MR::Vector3f::diagonal(spacing_);
+    const MR::Vector3f size = box.size();
+    for (int k = 0; k < 3; ++k)
+    {
+        dims_[k] = static_cast<int>(std::ceil(size[k] / spacing_)) + 3;
+    }
+    
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const int ua = (axis + 1) % 3;
+        const int va = (axis + 2) % 3;
+        const size_t tilesU = (dims_[ua] + kTileRays - 1) / kTileRays;
+        const size_t tilesV = (dims_[va] + kTileRays - 1) / kTileRays;
+        rays_[axis].clear();
+        rays_[axis].resize(tilesU * tilesV);
+    }
+    
+    // 每轴 dims_ - 1 个格子
+    for (int k = 0; k < 3; ++k)
+    {
+        blockDims_[k] = (dims_[k] - 2) / kBlockCells + 1;
+    }
+    const size_t numBlocks = static_cast<size_t>(blockDims_.x) * blockDims_.y * blockDims_.z;
+    blockMeshes_.clear();
+    blockMeshes_.resize(numBlocks);
+    dirtyBlocks_.clear();
+    dirtyBlocks_.resize(numBlocks, true);
+    
+    meshCache_.reset();
+    moveCount_ = 0;
+}
+
+size_t DexelEngine::tileIndex(int axis, int u, int v) const
+{
+    const int tilesU = (dims_[(axis + 1) % 3] + kTileRays - 1) / kTileRays;
+    return static_cast<size_t>(v / kTileRays) * tilesU + u / kTileRays;
+}
+
+const DexelEngine::Ray* DexelEngine::findRay(int axis, int u, int v) const
+{
+    const std::vector<Ray>& tile = rays_[axis][tileIndex(axis, u, v)];
+    if (tile.empty())
+    {
+        return nullptr;
+    }
+    return &tile[(v % kTileRays) * kTileRays + u % kTileRays];
+}
+
+DexelEngine::Ray* DexelEngine::findRay(int axis, int u, int v)
+{
+    return const_cast<Ray*>(static_cast<const DexelEngine*>(this)->findRay(axis, u, v));
+}
+
+DexelEngine::Ray& DexelEngine::allocateRay(int axis, int u, int v)
+{
+    std::vector<Ray>& tile = rays_[axis][tileIndex(axis, u, v)];
+    if (tile.empty())
+    {
+        tile.resize(kTileRays * kTileRays);
+    }
+    return tile[(v % kTileRays) * kTileRays + u % kTileRays];
+}
+
+float DexelEngine::coord(int axis, int i) const
+{
+    return origin_[axis] + i * spacing_;
+}
+
+void DexelEngine::setStockBox(const MR::Box3f& box)
+{
+    allocate(box);
+    
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const int ua = (axis + 1) % 3;
+        const int va = (axis + 2) % 3;
+        for (int v = 0; v < dims_[va]; ++v)
+        {
+            const float cv = coord(va, v);
+            if (cv < box.min[va] || cv > box.max[va])
+                continue;
+            for (int u = 0; u < dims_[ua]; ++u)
+            {
+                const float cu = coord(ua, u);
+                if (cu < box.min[ua] || cu > box.max[ua])
+                    continue;
+                allocateRay(axis, u, v) = {DexelInterval{box.min[axis], box.max[axis]}};
+            }
+        }
+    }
+}
+
+bool DexelEngine::setStock(const MR::Mesh& mesh, const MR::ProgressCallback& cb)
+{
+    if (mesh.points.empty())
+    {
+        reset();
+        return true;
+    }
+    
+    allocate(mesh.computeBoundingBox());
+    
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const int ua = (axis + 1) % 3;
+        const int va = (axis + 2) % 3;
+        MR::Vector3d dir;
+        dir[axis] = 1.0;
+        
+        // 每条射线与网格求交，按距离排序后两两配对为材料区间；
+        // 按小块并行，整块射线都没有材料时不分配
+        const int tilesU = (dims_[ua] + kTileRays - 1) / kTileRays;
+        const bool ok = MR::ParallelFor(size_t(0), rays_[axis].size(), [&](size_t idx)
+        {
+            const int u0 = static_cast<int>(idx % tilesU) * kTileRays;
+            const int v0 = static_cast<int>(idx / tilesU) * kTileRays;
+            std::vector<Ray> tile(kTileRays * kTileRays);
+            bool hasMaterial = false;
+            std::vector<float> hits;
+            for (int v = v0; v < std::min(v0 + kTileRays, dims_[va]); ++v)
+            {
+                for (int u = u0; u < std::min(u0 + kTileRays, dims_[ua]); ++u)
+                {
+                    MR::Vector3d start;
+                    start[axis] = origin_[axis];
+                    start[ua] = coord(ua, u);
+                    start[va] = coord(va, v);
+                    
+                    hits.clear();
+                    MR::rayMeshIntersectAll(mesh, MR::Line3d(start, dir), [&](const MR::MeshIntersectionResult& hit)
+                    {
+                        hits.push_back(hit.distanceAlongLine);
+                        return true;
+                    });
+                    std::sort(hits.begin(), hits.end());
+                    
+                    Ray& ray = tile[(v - v0) * kTileRays + (u - u0)];
+                    for (size_t h = 0; h + 1 < hits.size(); h += 2)
+                    {
+                        ray.push_back(DexelInterval{origin_[axis] + hits[h], origin_[axis] + hits[h + 1]});
+                    }
+                    hasMaterial = hasMaterial || !ray.empty();
+                }
+            }
+            if (hasMaterial)
+            {
+                rays_[axis][idx] = std::move(tile);
+            }
+        }, MR::subprogress(cb, axis / 3.0f, (axis + 1) / 3.0f));
+        
+        if (!ok)
+        {
+            reset();
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void DexelEngine::clip(Ray& ray, float start, float end)
+{
+    // 大多数射线只有 1~3 段区间，原地重排
+    Ray clipped;
+    clipped.reserve(ray.size() + 1);
+    for (const auto& iv : ray)
+    {
+        if (iv.end <= start || iv.start >= end)
+        {
+            clipped.push_back(iv);
+            continue;
+        }
+        if (iv.start < start)
+            clipped.push_back(DexelInterval{iv.start, start});
+        if (iv.end > end)
+            clipped.push_back(DexelInterval{end, iv.end});
+    }
+    ray.swap(clipped);
+}
+
+BooleanResult DexelEngine::subtractCylinder(const CylinderParams& tool, const MR::Vector3f& center,
+                                            const MR::ProgressCallback& cb)
+{
+    return subtractSweep(tool, center, center, cb);
+}
+
+BooleanResult DexelEngine::subtractSweep(const CylinderParams& tool, const MR::Vector3f& from, const MR::Vector3f& to,
+                                         const MR::ProgressCallback& cb)
+{
+    BooleanResult result;
+    
+    if (!hasStock())
+    {
+        result.errorMsg = "Mesh A is empty";
+        return result;
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    // 只复制刀具范围内的射线，生成网格失败或被取消时用它恢复毛坯
+    MR::Vector3i lo, hi;
+    const bool touched = sweepRange(tool, from, to, lo, hi);
+    Snapshot snapshot = save(lo, hi);
+    if (touched)
+    {
+        clipSweep(tool, from, to, lo, hi);
+        markDirty(lo, hi);
+        meshCache_.reset();
+    }
+    ++moveCount_;
+    
+    auto mesh = buildMesh(cb);
+    if (!mesh.has_value())
+    {
+        restore(snapshot);
+        result.errorMsg = mesh.error() == MR::stringOperationCanceled() ?
+                          std::string(BooleanOperator::kCanceledMsg) : mesh.error();
+        return result;
+    }
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    result.durationMs = static_cast<float>(elapsed.count());
+    result.mesh = *mesh;
+    result.success = true;
+    
+    return result;
+}
+
+void DexelEngine::moveTool(const CylinderParams& tool, const MR::Vector3f& from, const MR::Vector3f& to)
+{
+    if (!hasStock())
+    {
+        return;
+    }
+    
+    MR::Vector3i lo, hi;
+    if (sweepRange(tool, from, to, lo, hi))
+    {
+        clipSweep(tool, from, to, lo, hi);
+        markDirty(lo, hi);
+        meshCache_.reset();
+    }
+    ++moveCount_;
+}
+
+bool DexelEngine::sweepRange(const CylinderParams& tool, const MR::Vector3f& from, const MR::Vector3f& to,
+                             MR::Vector3i& lo, MR::Vector3i& hi) const
+{
+    const float r = tool.getRadius();
+    const float h2 = tool.length / 2.0f;
+    
+    // 扫掠体的包围盒决定需要处理的射线范围
+    MR::Box3f sweepBox;
+    sweepBox.include(from);
+    sweepBox.include(to);
+    sweepBox.min -= MR::Vector3f(r, r, h2);
+    sweepBox.max += MR::Vector3f(r, r, h2);
+    
+    bool empty = false;
+    for (int k = 0; k < 3; ++k)
+    {
+        lo[k] = std::max(0, static_cast<int>(std::ceil((sweepBox.min[k] - origin_[k]) / spacing_)));
+        hi[k] = std::min(dims_[k] - 1, static_cast<int>(std::floor((sweepBox.max[k] - origin_[k]) / spacing_)));
+        empty = empty || lo[k] > hi[k];
+    }
+    return !empty;
+}
+
+void DexelEngine::clipSweep(const CylinderParams& tool, const MR::Vector3f& from, const MR::Vector3f& to,
+                            const MR::Vector3i& lo, const MR::Vector3i& hi)
+{
+    const float r = tool.getRadius();
+    const float h2 = tool.length / 2.0f;
+    const MR::Vector3f d = to - from;
+    
+    // 刀具中心高度 z 在 [c - h2, c + h2] 内对应的参数 t 范围
+    auto zRange = [&](float z)
+    {
+        if (std::abs(d.z) < kEps)
+            return std::abs(z - from.z) <= h2 ? Range{0.0f, 1.0f} : Range{};
+        Range t = solveLinear(d.z, from.z, z - h2, z + h2);
+        t.intersect(Range{0.0f, 1.0f});
+        return t;
+    };
+    
+    const MR::Vector2f a2(from.x, from.y);
+    const MR::Vector2f d2(d.x, d.y);
+    
+    // Z 向射线：圆盘沿 XY 投影扫过 (x, y) 的参数范围决定 z 区间
+    {
+        MR::ParallelFor(lo.y, hi.y + 1, [&](int j)
+        {
+            const float y = coord(1, j);
+            for (int i = lo.x; i <= hi.x; ++i)
+            {
+                const MR::Vector2f w = MR::Vector2f(coord(0, i), y) - a2;
+                const float dd = MR::dot(d2, d2);
+                Range t{0.0f, 1.0f};
+                if (dd < kEps)
+                {
+                    if (MR::dot(w, w) > r * r)
+                        continue;
+                }
+                else
+                {
+                    const float wd = MR::dot(w, d2);
+                    const float disc = wd * wd - dd * (MR::dot(w, w) - r * r);
+                    if (disc < 0)
+                        continue;
+                    const float sq = std::sqrt(disc);
+                    t.intersect(Range{(wd - sq) / dd, (wd + sq) / dd});
+                    if (t.empty())
+                        continue;
+                }
+                const float za = from.z + t.lo * d.z;
+                const float zb = from.z + t.hi * d.z;
+                if (Ray* ray = findRay(2, i, j))
+                    clip(*ray, std::min(za, zb) - h2, std::max(za, zb) + h2);
+            }
+        });
+    }
+    
+    // X 向射线 (u = y, v = z) 与 Y 向射线 (u = z, v = x)：
+    // 先由高度求参数范围，再求对应胶囊体在 XY 平面内的截线
+    {
+        MR::ParallelFor(lo.z, hi.z + 1, [&](int k)
+        {
+            const Range t = zRange(coord(2, k));
+            if (t.empty())
+                return;
+            const MR::Vector2f p0 = a2 + d2 * t.lo;
+            const MR::Vector2f p1 = a2 + d2 * t.hi;
+            for (int j = lo.y; j <= hi.y; ++j)
+            {
+                const Range x = capsuleSection(p0, p1, r, coord(1, j));
+                Ray* ray = findRay(0, j, k);
+                if (ray && !x.empty())
+                    clip(*ray, x.lo, x.hi);
+            }
+        });
+    }
+    {
+        MR::ParallelFor(lo.z, hi.z + 1, [&](int k)
+        {
+            const Range t = zRange(coord(2, k));
+            if (t.empty())
+                return;
+            // 交换 XY，使截线方向与 capsuleSection 一致
+            const MR::Vector2f p0(from.y + d.y * t.lo, from.x + d.x * t.lo);
+            const MR::Vector2f p1(from.y + d.y * t.hi, from.x + d.x * t.hi);
+            for (int i = lo.x; i <= hi.x; ++i)
+            {
+                const Range y = capsuleSection(p0, p1, r, coord(0, i));
+                Ray* ray = findRay(1, k, i);
+                if (ray && !y.empty())
+                    clip(*ray, y.lo, y.hi);
+            }
+        });
+    }
+}
+
+DexelEngine::Snapshot DexelEngine::save(const MR::Vector3i& lo, const MR::Vector3i& hi) const
+{
+    Snapshot snapshot;
+    snapshot.lo = lo;
+    snapshot.hi = hi;
+    snapshot.moveCount = moveCount_;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const int ua = (axis + 1) % 3;
+        const int va = (axis + 2) % 3;
+        for (int v = lo[va]; v <= hi[va]; ++v)
+        {
+            for (int u = lo[ua]; u <= hi[ua]; ++u)
+            {
+                // 裁剪不会分配新的小块，未分配的射线无需保存
+                const Ray* ray = findRay(axis, u, v);
+                snapshot.rays[axis].push_back(ray ? *ray : Ray());
+            }
+        }
+    }
+    return snapshot;
+}
+
+void DexelEngine::restore(Snapshot& snapshot)
+{
+    const MR::Vector3i& lo = snapshot.lo;
+    const MR::Vector3i& hi = snapshot.hi;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const int ua = (axis + 1) % 3;
+        const int va = (axis + 2) % 3;
+        size_t n = 0;
+        for (int v = lo[va]; v <= hi[va]; ++v)
+        {
+            for (int u = lo[ua]; u <= hi[ua]; ++u)
+            {
+                Ray& saved = snapshot.rays[axis][n++];
+                if (Ray* ray = findRay(axis, u, v))
+                    ray->swap(saved);
+            }
+        }
+    }
+    
+    // 分块网格可能已按裁剪后的射线重新生成，恢复后再标记一次
+    if (lo.x <= hi.x && lo.y <= hi.y && lo.z <= hi.z)
+    {
+        markDirty(lo, hi);
+    }
+    meshCache_.reset();
+    moveCount_ = snapshot.moveCount;
+}
+
+void DexelEngine::markDirty(const MR::Vector3i& lo, const MR::Vector3i& hi)
+{
+    // 格点的距离只取决于经过它的射线上 2 * spacing_ 以内的区间边界，
+    // 被裁剪的边界最多在范围外一个格点间距处，因此向外扩三个格点
+    constexpr int kMargin = 3;
+    MR::Vector3i b0, b1;
+    for (int k = 0; k < 3; ++k)
+    {
+        const int s0 = std::max(0, lo[k] - kMargin);
+        const int s1 = std::min(dims_[k] - 1, hi[k] + kMargin);
+        // 格点 s 是格子 s - 1 和 s 的顶点
+        b0[k] = std::max(0, s0 - 1) / kBlockCells;
+        b1[k] = std::min(s1, dims_[k] - 2) / kBlockCells;
+    }
+    
+    for (int bz = b0.z; bz <= b1.z; ++bz)
+    {
+        for (int by = b0.y; by <= b1.y; ++by)
+        {
+            for (int bx = b0.x; bx <= b1.x; ++bx)
+            {
+                dirtyBlocks_.set((static_cast<size_t>(bz) * blockDims_.y + by) * blockDims_.x + bx);
+            }
+        }
+    }
+}
+
+float DexelEngine::sample(int i, int j, int k) const
+{
+    // 每个格点同时位于三条射线上：符号取三条射线的多数表决，
+    // 距离取沿三个方向到区间边界的最小值，使表面位置保持亚格点精度
+    const float maxDist = 2.0f * spacing_;
+    const float dz = signedDistance(findRay(2, i, j), coord(2, k), maxDist);
+    const float dx = signedDistance(findRay(0, j, k), coord(0, i), maxDist);
+    const float dy = signedDistance(findRay(1, k, i), coord(1, j), maxDist);
+    const int insideVotes = (dz < 0) + (dx < 0) + (dy < 0);
+    const float dist = std::min({std::abs(dz), std::abs(dx), std::abs(dy)});
+    return insideVotes >= 2 ? -dist : dist;
+}
+
+
+MeshHandle DexelEngine::getMesh(const MR::ProgressCallback& cb)
+{
+    if (!hasStock())
+    {
+        return {};
+    }
+    
+    auto mesh = buildMesh(cb);
+    if (!mesh.has_value())
+    {
+        return {};
+    }
+    return *mesh;
+}
+
+MR::Expected<MeshHandle> DexelEngine::buildMesh(const MR::ProgressCallback& cb)
+{
+    if (meshCache_)
+    {
+        return meshCache_;
+    }
+    
+    std::vector<size_t> dirty;
+    for (size_t b : dirtyBlocks_)
+    {
+        dirty.push_back(b);
+    }
+    
+    // 只对被切割过的分块运行 Marching Cubes，每块只分配自身大小的体数据，
+    // 不随整个毛坯的格点数增长。全部成功后才替换缓存的分块网格
+    std::vector<std::unique_ptr<MR::Mesh>> fresh(dirty.size());
+    std::atomic<bool> failed{false};
+    const bool ok = MR::ParallelFor(size_t(0), dirty.size(), [&](size_t n)
+    {
+        const size_t b = dirty[n];
+        const MR::Vector3i block(static_cast<int>(b % blockDims_.x),
+                                 static_cast<int>(b / blockDims_.x % blockDims_.y),
+                                 static_cast<int>(b / (static_cast<size_t>(blockDims_.x) * blockDims_.y)));
+        
+        // 相邻分块共享边界上的格点，边界上的顶点位置一致，拼接后焊接
+        MR::Vector3i s0, s1;
+        for (int k = 0; k < 3; ++k)
+        {
+            s0[k] = block[k] * kBlockCells;
+            s1[k] = std::min(s0[k] + kBlockCells, dims_[k] - 1);
+        }
+        
+        MR::SimpleVolume volume;
+        volume.dims = s1 - s0 + MR::Vector3i::diagonal(1);
+        volume.voxelSize = MR::Vector3f::diagonal(spacing_);
+        volume.data.resize(static_cast<size_t>(volume.dims.x) * volume.dims.y * volume.dims.z);
+        size_t idx = 0;
+        for (int k = s0.z; k <= s1.z; ++k)
+        {
+            for (int j = s0.y; j <= s1.y; ++j)
+            {
+                for (int i = s0.x; i <= s1.x; ++i)
+                {
+                    volume.data[idx++] = sample(i, j, k);
+                }
+            }
+        }
+        
+        MR::MarchingCubesParams params;
+        params.origin = MR::Vector3f(coord(0, s0.x), coord(1, s0.y), coord(2, s0.z));
+        params.iso = 0.0f;
+        params.lessInside = true;
+        
+        auto mesh = MR::marchingCubes(volume, params);
+        if (!mesh.has_value())
+        {
+            failed = true;
+            return;
+        }
+        if (!mesh->points.empty())
+        {
+            fresh[n] = std::make_unique<MR::Mesh>(std::move(*mesh));
+        }
+    }, MR::subprogress(cb, 0.0f, 0.8f));
+    
+    if (!ok)
+    {
+        return MR::unexpectedOperationCanceled();
+    }
+    if (failed)
+    {
+        return MR::unexpected(std::string("Failed to convert dexels to mesh"));
+    }
+    
+    for (size_t n = 0; n < dirty.size(); ++n)
+    {
+        blockMeshes_[dirty[n]] = std::move(fresh[n]);
+    }
+    dirtyBlocks_.reset();
+    
+    // 拼接各分块，焊接分块边界上重合的顶点
+    MR::Mesh mesh;
+    for (const auto& part : blockMeshes_)
+    {
+        if (part)
+        {
+            mesh.addMesh(*part);
+        }
+    }
+    MR::MeshBuilder::uniteCloseVertices(mesh, spacing_ * 1e-3f, true);
+    
+    meshCache_ = std::move(mesh);
+    return meshCache_;
+}
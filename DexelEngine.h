@@ -0,0 +1,188 @@
+/**
+ * @file DexelEngine.h
+ * @brief 三向 Dexel 材料去除引擎
+ * 
+ * 毛坯用三组正交射线上的深度区间表示，刀具切割变为每条射线上的区间裁剪，
+ * 各射线互不相关，可完全并行；只在显示时才转换为三角网格，
+ * 且只重新生成被切割过的分块
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRBox.h>
+#include <MRMesh/MRProgressCallback.h>
+#include <MRMesh/MRBitSet.h>
+#include <MRMesh/MRExpected.h>
+#include <memory>
+#include <vector>
+#include "CylinderGenerator.h"
+#include "BooleanOperator.h"
+#include "MeshHandle.h"
+
+/**
+ * @brief 射线上的一段材料区间 [start, end]
+ */
+struct DexelInterval
+{
+    float start = 0.0f;
+    float end = 0.0f;
+};
+
+/**
+ * @brief 三向 Dexel 引擎类
+ * 
+ * 三组射线分别沿 X、Y、Z 方向，共享同一个规则格点：
+ * 沿某轴的射线位于另外两个轴的格点上。刀具为轴向 Z 的平底圆柱（三轴加工）
+ */
+class DexelEngine
+{
+public:
+    explicit DexelEngine(float spacing = 0.1f);
+    ~DexelEngine() = default;
+    
+    /**
+     * @brief 设置射线间距 (mm)，会清除当前毛坯
+     */
+    void setSpacing(float spacing);
+    
+    /**
+     * @brief 获取射线间距 (mm)
+     */
+    float getSpacing() const { return spacing_; }
+    
+    /**
+     * @brief 用长方体初始化毛坯（无需射线求交）
+     */
+    void setStockBox(const MR::Box3f& box);
+    
+    /**
+     * @brief 用封闭三角网格初始化毛坯（每条射线与网格求交）
+     * @return 被取消时返回 false
+     */
+    bool setStock(const MR::Mesh& mesh, const MR::ProgressCallback& cb = {});
+    
+    /**
+     * @brief 是否已有毛坯
+     */
+    bool hasStock() const { return !rays_[0].empty(); }
+    
+    /**
+     * @brief 清除毛坯
+     */
+    void reset();
+    
+    /**
+     * @brief 在指定位置用圆柱刀具切割并生成切割后的三角网格
+     * 
+     * 生成网格成功后才保留裁剪结果；被取消（errorMsg 为 BooleanOperator::kCanceledMsg）
+     * 或失败时恢复被裁剪的射线，毛坯保持不变
+     * 
+     * @param tool 刀具参数
+     * @param center 圆柱体中心位置
+     * @return mesh 为切割后毛坯的三角网格
+     */
+    BooleanResult subtractCylinder(const CylinderParams& tool, const MR::Vector3f& center,
+                                   const MR::ProgressCallback& cb = {});
+    
+    /**
+     * @brief 刀具沿直线段移动并生成切割后的三角网格，失败时同 subtractCylinder 恢复毛坯
+     * @param from 起点（圆柱体中心）
+     * @param to 终点（圆柱体中心）
+     */
+    BooleanResult subtractSweep(const CylinderParams& tool, const MR::Vector3f& from, const MR::Vector3f& to,
+                                const MR::ProgressCallback& cb = {});
+    
+    /**
+     * @brief 刀具沿直线段移动，去除扫过的材料
+     * 
+     * 只裁剪射线并标记受影响的分块，网格在下次 getMesh 时才重新生成，
+     * 连续移动多段时不会每段都重新生成网格
+     * 
+     * @param tool 刀具参数
+     * @param from 起点（圆柱体中心）
+     * @param to 终点（圆柱体中心）
+     */
+    void moveTool(const CylinderParams& tool, const MR::Vector3f& from, const MR::Vector3f& to);
+    
+    /**
+     * @brief 获取毛坯的三角网格，毛坯未改变时直接返回缓存
+     * 
+     * 只对上次生成网格以来被切割过的分块重新运行 Marching Cubes，
+     * 其余分块沿用缓存的网格，不分配整个格点的体数据
+     * 
+     * @return 转换失败、被取消或没有毛坯时返回空句柄
+     */
+    MeshHandle getMesh(const MR::ProgressCallback& cb = {});
+    
+    /**
+     * @brief 自初始化以来的刀具移动次数
+     */
+    int getMoveCount() const { return moveCount_; }
+
+private:
+    using Ray = std::vector<DexelInterval>;
+    
+    /**
+     * @brief 一次切割涉及的格点范围 [lo, hi] 内所有射线在切割前的副本
+     */
+    struct Snapshot
+    {
+        MR::Vector3i lo;
+        MR::Vector3i hi;
+        std::vector<Ray> rays[3];
+        int moveCount = 0;
+    };
+    
+    void allocate(const MR::Box3f& box);
+    size_t tileIndex(int axis, int u, int v) const;
+    
+    /**
+     * @brief 沿 axis 方向、位于格点 (u, v) 的射线，所在小块未分配时返回空指针
+     */
+    const Ray* findRay(int axis, int u, int v) const;
+    Ray* findRay(int axis, int u, int v);
+    Ray& allocateRay(int axis, int u, int v);
+    float coord(int axis, int i) const;
+    static void clip(Ray& ray, float start, float end);
+    
+    /**
+     * @brief 刀具沿直线段扫过的格点范围，为空时返回 false
+     */
+    bool sweepRange(const CylinderParams& tool, const MR::Vector3f& from, const MR::Vector3f& to,
+                    MR::Vector3i& lo, MR::Vector3i& hi) const;
+    void clipSweep(const CylinderParams& tool, const MR::Vector3f& from, const MR::Vector3f& to,
+                   const MR::Vector3i& lo, const MR::Vector3i& hi);
+    Snapshot save(const MR::Vector3i& lo, const MR::Vector3i& hi) const;
+    void restore(Snapshot& snapshot);
+    
+    /**
+     * @brief 标记格点范围 [lo, hi] 内射线改变后需要重新生成网格的分块
+     */
+    void markDirty(const MR::Vector3i& lo, const MR::Vector3i& hi);
+    
+    /**
+     * @brief 格点 (i, j, k) 处的有符号距离（内部为负）
+     */
+    float sample(int i, int j, int k) const;
+    
+    MR::Expected<MeshHandle> buildMesh(const MR::ProgressCallback& cb);
+    
+    float spacing_ = 0.1f;
+    
+    // 格点：origin_ + i * spacing_，每轴 dims_ 个
+    MR::Vector3f origin_;
+    MR::Vector3i dims_;
+    
+    // rays_[axis] 为沿 axis 方向的射线，按另外两个轴的格点分成 kTileRays x kTileRays 的小块，
+    // 不含材料的小块不分配（为空）
+    std::vector<std::vector<Ray>> rays_[3];
+    
+    // 分块网格：每块 kBlockCells^3 个格子，相邻块共享边界上的格点
+    MR::Vector3i blockDims_;
+    std::vector<std::unique_ptr<MR::Mesh>> blockMeshes_;  // 没有表面的分块为空
+    MR::BitSet dirtyBlocks_;
+    
+    MeshHandle meshCache_;
+    int moveCount_ = 0;
+};
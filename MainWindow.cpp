@@ -4,6 +4,8 @@
  */
 
 #include "MainWindow.h"
+#include "CutCache.h"
+#include "MeshLayout.h"
 #include <MRMesh/MRMeshLoad.h>
 #include <MRMesh/MRMeshSave.h>
 #include <MRMesh/MRBox.h>
@@ -20,6 +22,8 @@
 #include <QLabel>
 #include <QFrame>
 #include <QSplitter>
+#include <QSignalBlocker>
+#include <QCheckBox>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -28,9 +32,31 @@ MainWindow::MainWindow(QWidget* parent)
     setWindowTitle("Mesh Boolean Cutter - MeshLib + Qt");
     resize(1200, 800);
     
-    // 创建圆柱体网格（初始位置）
-    MR::Mesh cylinder = cylinderGen_.generate();
-    cutterMesh_ = std::make_shared<MR::Mesh>(std::move(cylinder));
+    // 创建圆柱体网格（规范位置），之后移动刀具只改变位姿，不再重新生成网格
+    cutterMesh_ = cylinderGen_.generate();
+    booleanOp_.setCylinderCutter(cutterMesh_.get(), cylinderGen_.getParams());
+    
+    // 启用窗口模式：切割耗时只与刀具大小相关，与模型大小无关
+    WindowParams windowParams;
+    windowParams.enabled = true;
+    booleanOp_.setWindowParams(windowParams);
+    
+    // 后台布尔运算工作器
+    cutWorker_ = new BooleanWorker(this);
+    connect(cutWorker_, &BooleanWorker::progressChanged, this, &MainWindow::onCutProgress);
+    connect(cutWorker_, &BooleanWorker::finished, this, &MainWindow::onCutFinished);
+    
+    // 位置稳定一段时间后才启动推测性切割
+    speculativeTimer_ = new QTimer(this);
+    speculativeTimer_->setSingleShot(true);
+    speculativeTimer_->setInterval(250);
+    connect(speculativeTimer_, &QTimer::timeout, this, &MainWindow::onStartSpeculativeCut);
+    
+    // 同一轮事件循环内的多次位置改变合并为一次位姿更新
+    poseTimer_ = new QTimer(this);
+    poseTimer_->setSingleShot(true);
+    poseTimer_->setInterval(0);
+    connect(poseTimer_, &QTimer::timeout, this, &MainWindow::updateCutterPose);
     
     setupUI();
     createMenus();
@@ -40,9 +66,15 @@ MainWindow::MainWindow(QWidget* parent)
     
     // 初始化可视化器
     visualizer_->setCutterMesh(cutterMesh_);
+    visualizer_->setCutterTransform(cutterXf_);
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow()
+{
+    // 后台任务引用了 booleanOp_，必须在它析构前结束
+    cutWorker_->cancelAll();
+    cutWorker_->waitForIdle();
+}
 
 void MainWindow::setupUI()
 {
@@ -94,6 +126,24 @@ void MainWindow::setupUI()
     cutterLayout->addWidget(new QLabel("Diameter (直径):"), 1, 0);
     cutterLayout->addWidget(new QLabel(QString("%1 mm").arg(params.diameter)), 1, 1);
     
+    // 切割引擎：网格布尔运算、体素（SDF）运算或三向 Dexel 运算
+    cutterLayout->addWidget(new QLabel("Engine (引擎):"), 2, 0);
+    comboEngine_ = new QComboBox();
+    comboEngine_->addItem("Mesh Boolean (网格布尔)");
+    comboEngine_->addItem("Voxel SDF (体素)");
+    comboEngine_->addItem("Tri-Dexel (三向 Dexel)");
+    cutterLayout->addWidget(comboEngine_, 2, 1);
+    
+    cutterLayout->addWidget(new QLabel("Resolution (分辨率):"), 3, 0);
+    spinVoxelSize_ = new QDoubleSpinBox();
+    spinVoxelSize_->setRange(0.01, 5.0);
+    spinVoxelSize_->setDecimals(2);
+    spinVoxelSize_->setSingleStep(0.05);
+    spinVoxelSize_->setValue(voxelEngine_->getVoxelSize());
+    spinVoxelSize_->setSuffix(" mm");
+    spinVoxelSize_->setEnabled(false);
+    cutterLayout->addWidget(spinVoxelSize_, 3, 1);
+    
     leftLayout->addWidget(cutterGroup);
     
     // ===== 位置控制组 =====
@@ -162,6 +212,22 @@ void MainWindow::setupUI()
     btnCut_->setStyleSheet("QPushButton { background-color: #4CAF50; color: white; font-weight: bold; }");
     actionLayout->addWidget(btnCut_);
     
+    chkSweep_ = new QCheckBox("Sweep from last cut (从上次切割位置扫掠)");
+    chkSweep_->setToolTip("Remove the whole volume swept by the cutter moving in a straight line "
+                          "from the last cut position to the current one, with a single cut");
+    actionLayout->addWidget(chkSweep_);
+    
+    QHBoxLayout* progressLayout = new QHBoxLayout();
+    progressBar_ = new QProgressBar();
+    progressBar_->setRange(0, 100);
+    progressBar_->setValue(0);
+    progressBar_->setTextVisible(true);
+    btnCancel_ = new QPushButton("Cancel (取消)");
+    btnCancel_->setEnabled(false);
+    progressLayout->addWidget(progressBar_);
+    progressLayout->addWidget(btnCancel_);
+    actionLayout->addLayout(progressLayout);
+    
     btnReset_ = new QPushButton("Reset Position (重置位置)");
     actionLayout->addWidget(btnReset_);
     
@@ -198,6 +264,7 @@ void MainWindow::setupUI()
     connect(btnSave_, &QPushButton::clicked, this, &MainWindow::onSaveResult);
     connect(btnSavePiece_, &QPushButton::clicked, this, &MainWindow::onSaveCutPiece);
     connect(btnCut_, &QPushButton::clicked, this, &MainWindow::onExecuteCut);
+    connect(btnCancel_, &QPushButton::clicked, this, &MainWindow::onCancelCut);
     connect(btnReset_, &QPushButton::clicked, this, &MainWindow::onResetCutter);
     
     connect(spinX_, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
@@ -219,6 +286,11 @@ void MainWindow::setupUI()
     
     connect(comboVisualMode_, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onVisualModeChanged);
+    
+    connect(comboEngine_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onEngineChanged);
+    connect(spinVoxelSize_, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, &MainWindow::onEngineChanged);
 }
 
 void MainWindow::createMenus()
@@ -229,9 +301,9 @@ void MainWindow::createMenus()
     // File 菜单
     QMenu* fileMenu = menuBar->addMenu("File (文件)");
     
-    QAction* loadAction = fileMenu->addAction("Load Mesh (加载模型)");
-    loadAction->setShortcut(QKeySequence::Open);
-    connect(loadAction, &QAction::triggered, this, &MainWindow::onLoadTargetMesh);
+    loadAction_ = fileMenu->addAction("Load Mesh (加载模型)");
+    loadAction_->setShortcut(QKeySequence::Open);
+    connect(loadAction_, &QAction::triggered, this, &MainWindow::onLoadTargetMesh);
     
     QAction* saveAction = fileMenu->addAction("Save Result (保存结果)");
     saveAction->setShortcut(QKeySequence::Save);
@@ -243,6 +315,19 @@ void MainWindow::createMenus()
     exitAction->setShortcut(QKeySequence::Quit);
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
     
+    // Edit 菜单
+    QMenu* editMenu = menuBar->addMenu("Edit (编辑)");
+    
+    undoAction_ = editMenu->addAction("Undo Cut (撤销切割)");
+    undoAction_->setShortcut(QKeySequence::Undo);
+    connect(undoAction_, &QAction::triggered, this, &MainWindow::onUndoCut);
+    
+    redoAction_ = editMenu->addAction("Redo Cut (重做切割)");
+    redoAction_->setShortcut(QKeySequence::Redo);
+    connect(redoAction_, &QAction::triggered, this, &MainWindow::onRedoCut);
+    
+    updateHistoryActions();
+    
     // Help 菜单
     QMenu* helpMenu = menuBar->addMenu("Help (帮助)");
     
@@ -279,12 +364,33 @@ void MainWindow::onLoadTargetMesh()
         return;
     }
     
+    // 加载成功后才放弃旧目标上的任务：后台任务只持有旧目标的快照，
+    // 取消后不必等待，迟到的结果按任务编号丢弃
+    cancelBackgroundJobs();
+    if (pendingCutId_ != 0) {
+        cutWorker_->cancel(pendingCutId_);
+        pendingCutId_ = 0;
+        setCutRunning(false);
+    }
+    
     // 保存加载的网格
-    targetMesh_ = std::make_shared<MR::Mesh>(std::move(result.value()));
+    targetMesh_ = std::move(result.value());
+    ++targetVersion_;
+    resetVoxelStock();
+    resetDexelStock();
+    cutHistory_.clear();
+    simplifier_.clear();
+    updateHistoryActions();
+    invalidateSpeculativeCut();
+    lastCutPosition_.reset();
     currentFilePath_ = fileName;
     
+    // 在后台构建空间索引，后续切割复用
+    resetPreparedTarget();
+    resetMassProperties();
+    
     // 获取并保存目标网格的包围盒
-    targetBoundingBox_ = targetMesh_->computeBoundingBox();
+    targetBoundingBox_ = targetMesh_.boundingBox();
     
     // 输出包围盒信息到控制台
     qDebug() << "=== Target Mesh Bounding Box ===";
@@ -310,12 +416,12 @@ void MainWindow::onLoadTargetMesh()
     // 清除之前的结果
     resultMesh_.reset();
     cutPieceMesh_.reset();
-    visualizer_->setResultMesh(nullptr);
+    visualizer_->setResultMesh(MeshHandle());
 }
 
 void MainWindow::onSaveResult()
 {
-    if (!resultMesh_ || resultMesh_->points.empty()) {
+    if (resultMesh_.empty()) {
         QMessageBox::warning(this, "Warning (警告)", "No result to save (没有可保存的结果)");
         return;
     }
@@ -340,7 +446,7 @@ void MainWindow::onSaveResult()
 
 void MainWindow::onSaveCutPiece()
 {
-    if (!cutPieceMesh_ || cutPieceMesh_->points.empty()) {
+    if (cutPieceMesh_.empty()) {
         QMessageBox::warning(this, "Warning (警告)", 
             "No cut piece to save (没有可保存的碎片)\n请先执行切割操作");
         return;
@@ -372,26 +478,405 @@ void MainWindow::onExecuteCut()
         return;
     }
     
-    // 执行布尔差集运算 (A - B) - 保留切割后的主体
-    BooleanResult result = booleanOp_.difference(*targetMesh_, *cutterMesh_);
-    // BooleanResult result = booleanOp_.difference(*cutterMesh_, *targetMesh_);
+    if (pendingCutId_ != 0) {
+        return;
+    }
+    
+    // 还有未应用的位置改变：先更新位姿，保证切割使用最新位置
+    if (poseTimer_->isActive()) {
+        poseTimer_->stop();
+        updateCutterPose();
+    }
+    
+    // 扫掠切割：刀具从上次切割的位置沿直线移动到当前位置，整段扫过的体积只切割一次，
+    // 代替沿路径逐步移动的大量小切割
+    std::optional<MR::Vector3f> sweepFrom;
+    if (chkSweep_->isChecked() && lastCutPosition_ && *lastCutPosition_ != cutterPosition_) {
+        sweepFrom = lastCutPosition_;
+    }
+    pendingCutPosition_ = cutterPosition_;
+    
+    const bool speculationValid = !sweepFrom &&
+                                  speculativePosition_ == cutterPosition_ &&
+                                  speculativeTargetVersion_ == targetVersion_;
+    
+    // 推测性切割已完成：直接提交
+    if (speculationValid && speculativeResult_) {
+        auto result = std::move(speculativeResult_);
+        commitCutResult(*result);
+        return;
+    }
+    
+    // 推测性切割仍在运行：接管该任务并提升优先级
+    if (speculationValid && speculativeJobId_ != 0) {
+        pendingCutId_ = speculativeJobId_;
+        speculativeJobId_ = 0;
+        cutWorker_->setPriority(pendingCutId_, QThread::NormalPriority);
+        setCutRunning(true);
+        return;
+    }
+    
+    // 体素引擎：毛坯在体素网格中累积切割，只在显示时生成三角网格。
+    // 任务持有引擎对象，主窗口重置毛坯时换成新对象，不与任务竞争
+    if (usingVoxelEngine()) {
+        std::shared_ptr<VoxelCutEngine> engine = voxelEngine_;
+        MeshHandle cutter = cutterMesh_;
+        MeshHandle target = targetMesh_;
+        const MR::AffineXf3f xf = cutterXf_;
+        const CylinderGenerator gen = cylinderGen_;
+        const MR::Vector3f to = cutterPosition_;
+        pendingCutId_ = cutWorker_->start([engine, cutter, target, xf, gen, sweepFrom, to](const MR::ProgressCallback& cb) {
+            if (!engine->hasStock()) {
+                BooleanResult seeded = engine->setStock(*target, MR::subprogress(cb, 0.0f, 0.5f));
+                if (!seeded.success) {
+                    return seeded;
+                }
+            }
+            BooleanResult result;
+            if (sweepFrom) {
+                const MR::Mesh sweep = gen.generateSweep({*sweepFrom, to});
+                if (sweep.points.empty()) {
+                    result.errorMsg = "Failed to build the swept volume";
+                    return result;
+                }
+                result = engine->subtract(sweep, MR::AffineXf3f(), MR::subprogress(cb, 0.5f, 0.7f));
+            } else {
+                result = engine->subtract(*cutter, xf, MR::subprogress(cb, 0.5f, 0.7f));
+            }
+            if (!result.success) {
+                return result;
+            }
+            
+            // 只为显示生成一次网格；失败或被取消时撤回这次切割，毛坯仍与当前目标一致
+            auto mesh = engine->getMesh(MR::subprogress(cb, 0.7f, 1.0f));
+            if (!mesh.has_value()) {
+                engine->revertLastCut();
+                result.success = false;
+                result.errorMsg = mesh.error() == MR::stringOperationCanceled() ?
+                                  std::string(BooleanOperator::kCanceledMsg) :
+                                  "Failed to convert voxels to mesh: " + mesh.error();
+                return result;
+            }
+            result.mesh = std::move(*mesh);
+            return result;
+        });
+        setCutRunning(true);
+        return;
+    }
+    
+    // Dexel 引擎：刀具切割只裁剪射线上的深度区间，与网格复杂度无关
+    if (usingDexelEngine()) {
+        std::shared_ptr<DexelEngine> engine = dexelEngine_;
+        MeshHandle target = targetMesh_;
+        const CylinderParams tool = cylinderGen_.getParams();
+        const MR::Vector3f center = cutterPosition_;
+        pendingCutId_ = cutWorker_->start([engine, target, tool, center, sweepFrom](const MR::ProgressCallback& cb) {
+            if (!engine->hasStock() &&
+                !engine->setStock(*target, MR::subprogress(cb, 0.0f, 0.5f))) {
+                BooleanResult result;
+                result.errorMsg = BooleanOperator::kCanceledMsg;
+                return result;
+            }
+            // 射线只在生成网格成功后才保留裁剪结果，取消或失败时恢复，仍与当前目标一致
+            if (sweepFrom) {
+                return engine->subtractSweep(tool, *sweepFrom, center, MR::subprogress(cb, 0.5f, 1.0f));
+            }
+            return engine->subtractCylinder(tool, center, MR::subprogress(cb, 0.5f, 1.0f));
+        });
+        setCutRunning(true);
+        return;
+    }
+    
+    // 在后台线程中执行单次切割，界面保持响应，旧结果在新结果就绪前保持显示。
+    // 任务持有空间索引的快照，提交切割时若快照仍被持有则先复制再修改
+    std::shared_ptr<const PreparedTarget> prepared = preparedTarget_;
+    MeshHandle cutter = cutterMesh_;
+    const MR::AffineXf3f xf = cutterXf_;
+    const CylinderGenerator gen = cylinderGen_;
+    const MR::Vector3f to = cutterPosition_;
+    pendingCutId_ = cutWorker_->start([this, prepared, cutter, xf, gen, sweepFrom, to](const MR::ProgressCallback& cb) {
+        // 扫掠体在目标坐标系中生成，整段路径只做一次布尔运算
+        if (sweepFrom) {
+            const MR::Mesh sweep = gen.generateSweep({*sweepFrom, to});
+            if (sweep.points.empty()) {
+                BooleanResult result;
+                result.errorMsg = "Failed to build the swept volume";
+                return result;
+            }
+            return booleanOp_.cut(*prepared, sweep, cb);
+        }
+        return booleanOp_.cut(*prepared, *cutter, cb, &xf);
+    });
+    setCutRunning(true);
+}
+
+void MainWindow::onCancelCut()
+{
+    if (pendingCutId_ != 0) {
+        cutWorker_->cancel(pendingCutId_);
+        btnCancel_->setEnabled(false);
+    }
+}
+
+void MainWindow::onCutProgress(quint64 jobId, float progress)
+{
+    if (jobId == pendingCutId_) {
+        progressBar_->setValue(static_cast<int>(progress * 100.0f));
+    }
+}
+
+void MainWindow::onCutFinished(quint64 jobId, std::shared_ptr<BooleanResult> result)
+{
+    // 任务编号即任务的代数：取消任务时立即忘记其编号，不等待它结束，
+    // 之后迟到的结果与任何当前编号都不匹配，在这里被丢弃
+    
+    // 后台简化结束：目标未改变时直接提交
+    if (jobId == simplifyJobId_) {
+        simplifyJobId_ = 0;
+        if (result->success && !result->unchanged) {
+            applySimplifyResult(*result);
+        } else if (result->success) {
+            startCompact();
+        }
+        return;
+    }
+    
+    // 后台压缩结束
+    if (jobId == compactJobId_) {
+        compactJobId_ = 0;
+        if (result->success) {
+            applyCompactResult(*result);
+        }
+        return;
+    }
+    
+    // 推测性切割结束：结果留待按下切割按钮时提交
+    if (jobId == speculativeJobId_) {
+        speculativeJobId_ = 0;
+        if (result->success) {
+            speculativeResult_ = std::move(result);
+        }
+        return;
+    }
     
-    if (!result.success) {
+    if (jobId != pendingCutId_) {
+        return;
+    }
+    
+    pendingCutId_ = 0;
+    setCutRunning(false);
+    
+    if (!result->success) {
+        if (result->errorMsg == BooleanOperator::kCanceledMsg) {
+            qDebug() << "Cut canceled";
+            return;
+        }
         QMessageBox::critical(this, "Error (错误)", 
-            QString("Boolean operation failed:\n%1").arg(QString::fromStdString(result.errorMsg)));
+            QString("Boolean operation failed:\n%1").arg(QString::fromStdString(result->errorMsg)));
         return;
     }
     
-    // 保存结果网格
-    resultMesh_ = std::make_shared<MR::Mesh>(std::move(result.mesh));
+    commitCutResult(*result);
+}
+
+void MainWindow::setCutRunning(bool running)
+{
+    btnCut_->setEnabled(!running);
+    btnLoad_->setEnabled(!running);
+    loadAction_->setEnabled(!running);
+    btnCancel_->setEnabled(running);
+    progressBar_->setValue(0);
+}
+
+void MainWindow::onStartSpeculativeCut()
+{
+    // 体素/Dexel 引擎的切割会修改毛坯状态，不能推测执行；扫掠切割取决于上次切割位置，也不推测
+    if (!targetMesh_ || !cutterMesh_ || pendingCutId_ != 0 || speculativeJobId_ != 0 ||
+        usingVoxelEngine() || usingDexelEngine() || (chkSweep_->isChecked() && lastCutPosition_)) {
+        return;
+    }
+    
+    speculativePosition_ = cutterPosition_;
+    speculativeTargetVersion_ = targetVersion_;
+    
+    std::shared_ptr<const PreparedTarget> prepared = preparedTarget_;
+    MeshHandle cutter = cutterMesh_;
+    const MR::AffineXf3f xf = cutterXf_;
+    speculativeJobId_ = cutWorker_->start([this, prepared, cutter, xf](const MR::ProgressCallback& cb) {
+        return booleanOp_.cut(*prepared, *cutter, cb, &xf);
+    }, QThread::LowPriority);
+}
+
+void MainWindow::invalidateSpeculativeCut()
+{
+    // 新的位置或目标使正在运行的推测任务过期
+    if (speculativeJobId_ != 0) {
+        cutWorker_->cancel(speculativeJobId_);
+        speculativeJobId_ = 0;
+    }
+    speculativeResult_.reset();
+    speculativeTimer_->stop();
+}
+
+void MainWindow::cancelBackgroundJobs()
+{
+    invalidateSpeculativeCut();
+    cancelSimplify();
+    cancelCompact();
+}
+
+PreparedTarget& MainWindow::editPreparedTarget()
+{
+    // 后台任务仍持有当前索引的快照时先复制，正在运行的任务读取的索引不会被修改
+    if (preparedTarget_.use_count() > 1) {
+        preparedTarget_ = std::make_shared<PreparedTarget>(*preparedTarget_);
+    }
+    return *preparedTarget_;
+}
+
+void MainWindow::resetPreparedTarget()
+{
+    // 换成新对象在后台重新构建，旧索引由仍持有它的任务释放
+    preparedTarget_ = std::make_shared<PreparedTarget>();
+    preparedTarget_->reset(targetMesh_);
+}
+
+void MainWindow::resetVoxelStock()
+{
+    voxelEngine_ = std::make_shared<VoxelCutEngine>(voxelEngine_->getVoxelSize());
+}
+
+void MainWindow::resetDexelStock()
+{
+    dexelEngine_ = std::make_shared<DexelEngine>(dexelEngine_->getSpacing());
+}
+
+void MainWindow::startSimplify()
+{
+    cancelSimplify();
+    
+    // 体素/Dexel 引擎每次都重新生成整个网格，没有可累积的切割区域
+    if (!targetMesh_ || !simplifier_.hasWork() || usingVoxelEngine() || usingDexelEngine()) {
+        return;
+    }
+    
+    simplifyTargetVersion_ = targetVersion_;
+    MeshHandle target = targetMesh_;
+    const MR::FaceBitSet region = simplifier_.getRegion();
+    const SimplifyParams params = simplifier_.getParams();
+    simplifyJobId_ = cutWorker_->start([target, region, params](const MR::ProgressCallback& cb) {
+        return CutSimplifier::simplify(*target, region, params, cb);
+    }, QThread::LowPriority);
+}
+
+void MainWindow::cancelSimplify()
+{
+    if (simplifyJobId_ != 0) {
+        cutWorker_->cancel(simplifyJobId_);
+        simplifyJobId_ = 0;
+    }
+}
+
+void MainWindow::applySimplifyResult(BooleanResult& result)
+{
+    // 简化期间目标已被切割、撤销或替换，或者有切割正在读取当前网格：丢弃结果，
+    // 待简化区域保留到下一次提交切割后再处理
+    if (simplifyTargetVersion_ != targetVersion_ || pendingCutId_ != 0) {
+        return;
+    }
+    
+    // 推测和压缩任务基于旧网格，取消即可，不等待
+    invalidateSpeculativeCut();
+    cancelCompact();
+    
+    MeshHandle before = targetMesh_;
+    resultMesh_ = std::move(result.mesh);
     targetMesh_ = resultMesh_;
+    ++targetVersion_;
     visualizer_->setResultMesh(resultMesh_);
     
-    // 获取被切掉的碎片 (刀具内部的模型部分)
-    BooleanResult pieceResult = booleanOp_.getCutPiece(*targetMesh_, *cutterMesh_);
+    // 简化只改动区域内的面，按窗口切割的方式增量更新索引和历史
+    editPreparedTarget().applyCut(targetMesh_, result.removedFaces, result.addedFaces);
+    cutHistory_.push(before, result.removedFaces, result.addedFaces, result.massDelta, true);
+    updateHistoryActions();
+    massProps_ += result.massDelta;
+    simplifier_.clear();
+    updateInfoLabel();
+    
+    qDebug() << "Simplified cut region:" << result.removedFaces.count() << "->"
+             << result.addedFaces.count() << "faces in" << result.durationMs << "ms";
     
-    if (pieceResult.success && !pieceResult.mesh.points.empty()) {
-        cutPieceMesh_ = std::make_shared<MR::Mesh>(std::move(pieceResult.mesh));
+    startCompact();
+}
+
+void MainWindow::startCompact()
+{
+    cancelCompact();
+    
+    if (!targetMesh_ || usingVoxelEngine() || usingDexelEngine() ||
+        !MeshLayout::needsCompaction(*targetMesh_)) {
+        return;
+    }
+    
+    compactTargetVersion_ = targetVersion_;
+    MeshHandle target = targetMesh_;
+    compactJobId_ = cutWorker_->start([target](const MR::ProgressCallback& cb) {
+        return MeshLayout::optimize(*target, cb);
+    }, QThread::LowPriority);
+}
+
+void MainWindow::cancelCompact()
+{
+    if (compactJobId_ != 0) {
+        cutWorker_->cancel(compactJobId_);
+        compactJobId_ = 0;
+    }
+}
+
+void MainWindow::applyCompactResult(BooleanResult& result)
+{
+    if (compactTargetVersion_ != targetVersion_ || pendingCutId_ != 0) {
+        return;
+    }
+    
+    // 其余后台任务基于重排前的网格：取消即可，不等待
+    cancelBackgroundJobs();
+    
+    MeshHandle before = targetMesh_;
+    resultMesh_ = std::move(result.mesh);
+    targetMesh_ = resultMesh_;
+    ++targetVersion_;
+    visualizer_->setResultMesh(resultMesh_);
+    
+    // 编号全部改变：空间索引整体重建，历史保存重排前的完整网格，几何不变，质量特性不变
+    resetPreparedTarget();
+    cutHistory_.pushReplace(before, MassProperties(), true);
+    updateHistoryActions();
+    simplifier_.clear();
+    
+    // 压缩耗时和重排前后的缓存缺失随下一次切割的剖析报告一起输出
+    compactProfile_ += result.profile;
+}
+
+void MainWindow::commitCutResult(BooleanResult& result)
+{
+    // 刀具已移动到切割位置，下次扫掠切割从这里开始
+    lastCutPosition_ = pendingCutPosition_;
+    
+    // 刀具不接触材料：目标保持不变，不产生历史记录
+    if (result.unchanged) {
+        QMessageBox::information(this, "Info (提示)",
+            "The cutter does not touch any material (刀具未接触材料)");
+        return;
+    }
+    
+    // 其余（推测性、简化、压缩）任务基于旧的目标网格：取消即可，不等待。
+    // 它们只持有网格和索引的快照，下面的修改不会影响仍在运行的任务
+    cancelBackgroundJobs();
+    
+    // 保存碎片网格（刀具内部的模型部分）
+    if (!result.cutPiece.empty()) {
+        cutPieceMesh_ = std::move(result.cutPiece);
         btnSavePiece_->setEnabled(true);
         
         qDebug() << "=== Cut Piece Info ===";
@@ -399,29 +884,217 @@ void MainWindow::onExecuteCut()
         qDebug() << "Faces:" << cutPieceMesh_->topology.numValidFaces();
     }
     
+    // 保存结果网格
+    MeshHandle before = targetMesh_;
+    resultMesh_ = std::move(result.mesh);
+    targetMesh_ = resultMesh_;
+    ++targetVersion_;
+    visualizer_->setResultMesh(resultMesh_);
+    
+    // 更新空间索引：窗口模式和空腔保留了其余面的编号，只更新被切割影响的单元，否则后台重建
+    const bool keepsFaceIds = result.windowed || result.cavity;
+    if (keepsFaceIds) {
+        editPreparedTarget().applyCut(targetMesh_, result.removedFaces, result.addedFaces);
+    } else {
+        resetPreparedTarget();
+    }
+    
+    // 体素/Dexel 毛坯只与各自引擎的切割结果保持一致
+    if (!usingVoxelEngine()) {
+        resetVoxelStock();
+    }
+    if (!usingDexelEngine()) {
+        resetDexelStock();
+    }
+    
+    // 质量特性：布尔切割只累加改动区域的变化量，其他引擎整体重新计算
+    const MassProperties massBefore = massProps_;
+    if (result.hasMassDelta) {
+        massProps_ += result.massDelta;
+    } else {
+        massProps_ = MassProperties::compute(*targetMesh_);
+    }
+    lastRemovedVolume_ = massBefore.volume - massProps_.volume;
+    
+    // 记录历史：窗口切割和空腔切割只保存改动区域，整体替换保存切割前的网格；
+    // 同时记下质量特性的变化，撤销/重做时不必重新计算
+    if (keepsFaceIds) {
+        cutHistory_.push(before, result.removedFaces, result.addedFaces, massProps_ - massBefore);
+    } else {
+        cutHistory_.pushReplace(before, massProps_ - massBefore);
+    }
+    updateHistoryActions();
+    
+    // 窗口切割保留了其余面的编号，新增的面与之前尚未简化的区域合并；
+    // 整体替换后编号不再对应，放弃之前的区域
+    if (keepsFaceIds) {
+        simplifier_.addCut(result.removedFaces, result.addedFaces);
+    } else {
+        simplifier_.clear();
+    }
+    startSimplify();
+    if (simplifyJobId_ == 0) {
+        startCompact();
+    }
+    
+    updateInfoLabel();
+    
     // 自动切换到结果显示模式
     comboVisualMode_->setCurrentIndex(3);  // Result Only
     
     // 启用保存按钮
     btnSave_->setEnabled(true);
     
-    // 显示成功信息
-    QString msg = QString("Boolean operation completed in %1 ms\n"
-                          "Result: %2 vertices, %3 faces")
+    // 显示成功信息（富文本，阶段表格用等宽字体保持列对齐）
+    QString msg = QString("Boolean operation completed in %1 ms<br>"
+                          "Result: %2 vertices, %3 faces<br>"
+                          "Removed volume: %4 mm³")
                          .arg(result.durationMs, 0, 'f', 2)
                          .arg(resultMesh_->topology.numValidVerts())
-                         .arg(resultMesh_->topology.numValidFaces());
+                         .arg(resultMesh_->topology.numValidFaces())
+                         .arg(lastRemovedVolume_, 0, 'f', 3);
+    
+    // 各阶段耗时和分配次数，用于定位瓶颈；并入上次提交以来的后台压缩。
+    // 分配计数器是进程级的，阶段运行期间其他线程（后台任务、绘制）的分配也计算在内
+    result.profile += compactProfile_;
+    compactProfile_ = BooleanProfile();
+    const QString profile = QString::fromStdString(result.profile.toString());
+    qDebug().noquote() << "=== Cut Profile ===\n" + profile;
+    msg += "<br><br>Stage breakdown (阶段耗时):<pre>" + profile.toHtmlEscaped() + "</pre>"
+           "Allocation counts are process-wide and include other threads "
+           "(分配次数为进程内所有线程的总数)";
+    
+    // 切割缓存命中统计
+    const CutCache::Stats cacheStats = booleanOp_.getCache().getStats();
+    msg += QString("<br><br>Cut cache (切割缓存): %1%2 hits, %3 misses, %4 entries, %5 MB")
+               .arg(result.cacheHit ? "HIT - " : "")
+               .arg(cacheStats.hits)
+               .arg(cacheStats.misses)
+               .arg(cacheStats.entries)
+               .arg(cacheStats.bytes / double(1 << 20), 0, 'f', 1);
+    
+    QMessageBox box(QMessageBox::Information, "Success (成功)", msg, QMessageBox::Ok, this);
+    box.setTextFormat(Qt::RichText);
+    box.exec();
+}
+
+void MainWindow::onUndoCut()
+{
+    if (!cutHistory_.canUndo() || pendingCutId_ != 0) {
+        return;
+    }
+    
+    beginHistoryStep();
+    
+    // 后台简化是其所简化切割的附属步骤，与切割一起撤销。
+    // 所有步骤在同一个唯一持有的网格上应用，最后只发布和重新计算一次
+    applyHistoryStep(cutHistory_.undoChain(std::move(targetMesh_)));
+}
+
+void MainWindow::onRedoCut()
+{
+    if (!cutHistory_.canRedo() || pendingCutId_ != 0) {
+        return;
+    }
+    
+    beginHistoryStep();
+    
+    applyHistoryStep(cutHistory_.redoChain(std::move(targetMesh_)));
+}
+
+void MainWindow::beginHistoryStep()
+{
+    // 撤销/重做会修改当前网格：取消基于它的后台任务，不等待
+    cancelBackgroundJobs();
     
-    QMessageBox::information(this, "Success (成功)", msg);
+    // 释放当前网格的其他引用（体素/Dexel 毛坯此后也不再与目标一致，切割缓存中以它为结果的条目也丢弃），
+    // 增量步骤得以就地修改；网格仍被尚未结束的后台任务共享时会先复制
+    resetVoxelStock();
+    resetDexelStock();
+    resultMesh_.reset();
+    visualizer_->setResultMesh(MeshHandle());
+    editPreparedTarget().detachMesh();
+    booleanOp_.getCache().releaseMesh(targetMesh_);
+}
+
+void MainWindow::applyHistoryStep(CutHistory::Step step)
+{
+    targetMesh_ = std::move(step.mesh);
+    if (!targetMesh_) {
+        return;
+    }
+    
+    resultMesh_ = targetMesh_;
+    ++targetVersion_;
+    
+    // 质量特性按历史记下的变化量加减，耗时与改动大小无关
+    massProps_ += step.massDelta;
+    lastRemovedVolume_ = 0.0;
+    simplifier_.clear();
+    
+    // 增量步骤只更新改动区域的空间索引
+    if (step.incremental) {
+        editPreparedTarget().applyCut(targetMesh_, step.removedFaces, step.addedFaces);
+    } else {
+        resetPreparedTarget();
+    }
+    
+    visualizer_->setResultMesh(resultMesh_);
+    updateInfoLabel();
+    updateHistoryActions();
+}
+
+bool MainWindow::usingVoxelEngine() const
+{
+    return comboEngine_ && comboEngine_->currentIndex() == 1;
+}
+
+bool MainWindow::usingDexelEngine() const
+{
+    return comboEngine_ && comboEngine_->currentIndex() == 2;
+}
+
+void MainWindow::onEngineChanged()
+{
+    // 正在运行的任务持有旧的引擎对象：取消后不等待，换成新的引擎对象
+    cancelBackgroundJobs();
+    if (pendingCutId_ != 0) {
+        cutWorker_->cancel(pendingCutId_);
+        pendingCutId_ = 0;
+        setCutRunning(false);
+    }
+    
+    // 体素尺寸与 Dexel 射线间距共用同一个分辨率设置
+    const float resolution = static_cast<float>(spinVoxelSize_->value());
+    spinVoxelSize_->setEnabled(usingVoxelEngine() || usingDexelEngine());
+    voxelEngine_ = std::make_shared<VoxelCutEngine>(resolution);
+    dexelEngine_ = std::make_shared<DexelEngine>(resolution);
+}
+
+void MainWindow::updateHistoryActions()
+{
+    if (undoAction_) {
+        undoAction_->setEnabled(cutHistory_.canUndo());
+    }
+    if (redoAction_) {
+        redoAction_->setEnabled(cutHistory_.canRedo());
+    }
 }
 
 void MainWindow::onResetCutter()
 {
-    spinX_->setValue(0);
-    spinY_->setValue(0);
-    spinZ_->setValue(0);
+    // 三个输入框一起归零，只触发一次位姿更新
+    {
+        const QSignalBlocker blockX(spinX_);
+        const QSignalBlocker blockY(spinY_);
+        const QSignalBlocker blockZ(spinZ_);
+        spinX_->setValue(0);
+        spinY_->setValue(0);
+        spinZ_->setValue(0);
+    }
     cutterPosition_ = MR::Vector3f(0, 0, 0);
-    updateCutterMesh();
+    poseTimer_->stop();
+    updateCutterPose();
 }
 
 void MainWindow::onCutterPositionChanged()
@@ -429,15 +1102,25 @@ void MainWindow::onCutterPositionChanged()
     cutterPosition_.x = static_cast<float>(spinX_->value());
     cutterPosition_.y = static_cast<float>(spinY_->value());
     cutterPosition_.z = static_cast<float>(spinZ_->value());
-    updateCutterMesh();
+    poseTimer_->start();
 }
 
-void MainWindow::updateCutterMesh()
+void MainWindow::updateCutterPose()
 {
-    // 重新生成圆柱体在指定位置
-    MR::Mesh cylinder = cylinderGen_.generateAt(cutterPosition_);
-    cutterMesh_ = std::make_shared<MR::Mesh>(std::move(cylinder));
-    visualizer_->setCutterMesh(cutterMesh_);
+    // 只更新位姿，刀具网格保持不变，布尔运算通过 rigidB2A 使用该位姿
+    cutterXf_ = MR::AffineXf3f::translation(cutterPosition_);
+    visualizer_->setCutterTransform(cutterXf_);
+    
+    // 位置改变：旧的推测结果作废，等位置稳定后重新推测
+    invalidateSpeculativeCut();
+    speculativeTimer_->start();
+}
+
+void MainWindow::resetMassProperties()
+{
+    massProps_ = targetMesh_ ? MassProperties::compute(*targetMesh_) : MassProperties();
+    initialVolume_ = massProps_.volume;
+    lastRemovedVolume_ = 0.0;
 }
 
 void MainWindow::updateInfoLabel()
@@ -451,12 +1134,23 @@ void MainWindow::updateInfoLabel()
     text += QString("Vertices: %1\n").arg(targetMesh_->topology.numValidVerts());
     text += QString("Faces: %1\n").arg(targetMesh_->topology.numValidFaces());
     
-    auto bbox = targetMesh_->computeBoundingBox();
+    auto bbox = targetMesh_.boundingBox();
     text += QString("Size: %.2f x %.2f x %.2f mm")
                 .arg(bbox.max.x - bbox.min.x)
                 .arg(bbox.max.y - bbox.min.y)
                 .arg(bbox.max.z - bbox.min.z);
     
+    const MR::Vector3d centroid = massProps_.centroid();
+    text += QString("\nVolume: %1 mm³\n").arg(massProps_.volume, 0, 'f', 3);
+    text += QString("Area: %1 mm²\n").arg(massProps_.area, 0, 'f', 3);
+    text += QString("Centroid: (%1, %2, %3)\n")
+                .arg(centroid.x, 0, 'f', 3)
+                .arg(centroid.y, 0, 'f', 3)
+                .arg(centroid.z, 0, 'f', 3);
+    text += QString("Removed: %1 mm³ (last cut %2 mm³)")
+                .arg(initialVolume_ - massProps_.volume, 0, 'f', 3)
+                .arg(lastRemovedVolume_, 0, 'f', 3);
+    
     infoLabel_->setText(text);
 }
 
@@ -509,10 +1203,13 @@ void MainWindow::createInitialScene()
     MR::Vector3f boxCenter(0.0f, 0.0f, 15.0f);
     MR::Vector3f boxSize(20.0f, 20.0f, 25.0f);
     
-    initialMesh_ = std::make_shared<MR::Mesh>(createBoxMesh(boxCenter, boxSize));
+    initialMesh_ = createBoxMesh(boxCenter, boxSize);
     
     // 同时设置 targetMesh_（用于信息显示和布尔运算）
     targetMesh_ = initialMesh_;
+    ++targetVersion_;
+    resetPreparedTarget();
+    resetMassProperties();
     
     // 将初始场景作为目标网格设置到可视化器
     visualizer_->setTargetMesh(initialMesh_);
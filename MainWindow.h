@@ -12,11 +12,22 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QComboBox>
+#include <QProgressBar>
+#include <QTimer>
+#include <QCheckBox>
 #include <memory>
+#include <optional>
 #include "MRMesh/MRBox.h"
 #include "CutterVisualizer.h"
 #include "CylinderGenerator.h"
 #include "BooleanOperator.h"
+#include "PreparedTarget.h"
+#include "BooleanWorker.h"
+#include "CutHistory.h"
+#include "CutSimplifier.h"
+#include "VoxelCutEngine.h"
+#include "DexelEngine.h"
+#include "MassProperties.h"
 
 // 前置声明
 namespace MR {
@@ -55,6 +66,32 @@ private slots:
      */
     void onExecuteCut();
     
+    /**
+     * @brief 取消正在进行的切割
+     */
+    void onCancelCut();
+    
+    /**
+     * @brief 后台切割进度改变
+     */
+    void onCutProgress(quint64 jobId, float progress);
+    
+    /**
+     * @brief 后台切割结束
+     */
+    void onCutFinished(quint64 jobId, std::shared_ptr<BooleanResult> result);
+    
+    /**
+     * @brief 圆柱体位置稳定后启动推测性切割
+     */
+    void onStartSpeculativeCut();
+    
+    /**
+     * @brief 撤销/重做切割
+     */
+    void onUndoCut();
+    void onRedoCut();
+    
     /**
      * @brief 重置圆柱体位置
      */
@@ -84,13 +121,114 @@ private slots:
      * @brief 可视化模式改变
      */
     void onVisualModeChanged(int index);
+    
+    /**
+     * @brief 切割引擎或体素尺寸改变
+     */
+    void onEngineChanged();
 
 private:
     void setupUI();
     void createMenus();
-    void updateCutterMesh();
+    void updateCutterPose();
     void updateInfoLabel();
     
+    /**
+     * @brief 提交切割结果：替换目标网格并更新显示
+     */
+    void commitCutResult(BooleanResult& result);
+    
+    /**
+     * @brief 切换切割进行中的界面状态
+     */
+    void setCutRunning(bool running);
+    
+    /**
+     * @brief 取消正在运行的推测性切割并丢弃已有结果
+     */
+    void invalidateSpeculativeCut();
+    
+    /**
+     * @brief 取消推测性切割、后台简化和后台压缩（不等待，迟到的结果按任务编号丢弃）
+     */
+    void cancelBackgroundJobs();
+    
+    /**
+     * @brief 取得可修改的空间索引：仍被后台任务持有时先复制
+     */
+    PreparedTarget& editPreparedTarget();
+    
+    /**
+     * @brief 为当前目标网格换一个新的空间索引，在后台构建
+     */
+    void resetPreparedTarget();
+    
+    /**
+     * @brief 丢弃体素/Dexel 毛坯（换成同样设置的新引擎对象，仍在运行的任务不受影响）
+     */
+    void resetVoxelStock();
+    void resetDexelStock();
+    
+    /**
+     * @brief 在后台简化最近切割新增的面
+     */
+    void startSimplify();
+    
+    /**
+     * @brief 取消正在运行的后台简化（待简化区域保留）
+     */
+    void cancelSimplify();
+    
+    /**
+     * @brief 提交后台简化的结果，作为上一次切割的附属步骤记入历史
+     */
+    void applySimplifyResult(BooleanResult& result);
+    
+    /**
+     * @brief 编号空洞过多时在后台压缩目标网格并按空间填充曲线重排
+     */
+    void startCompact();
+    
+    /**
+     * @brief 取消正在运行的后台压缩
+     */
+    void cancelCompact();
+    
+    /**
+     * @brief 提交后台压缩的结果（编号全部改变），作为附属步骤记入历史
+     */
+    void applyCompactResult(BooleanResult& result);
+    
+    /**
+     * @brief 撤销/重做前结束后台任务并释放当前网格的其他引用
+     */
+    void beginHistoryStep();
+    
+    /**
+     * @brief 应用撤销/重做得到的网格
+     */
+    void applyHistoryStep(CutHistory::Step step);
+    
+    /**
+     * @brief 根据历史状态更新撤销/重做菜单项
+     */
+    void updateHistoryActions();
+    
+    /**
+     * @brief 当前是否使用体素切割引擎
+     */
+    bool usingVoxelEngine() const;
+    
+    /**
+     * @brief 当前是否使用三向 Dexel 切割引擎
+     */
+    bool usingDexelEngine() const;
+    
+    /**
+     * @brief 对新加载的目标网格重新计算质量特性
+     */
+    void resetMassProperties();
+    
     /**
      * @brief 创建初始场景（长方体）
      */
@@ -113,17 +251,69 @@ private:
     // 布尔运算器
     BooleanOperator booleanOp_;
     
-    // 网格数据
-    std::shared_ptr<MR::Mesh> targetMesh_;
-    std::shared_ptr<MR::Mesh> initialMesh_;  // 初始场景的长方体
-    std::shared_ptr<MR::Mesh> cutterMesh_;
-    std::shared_ptr<MR::Mesh> resultMesh_;
+    // 体素切割引擎（毛坯在第一次体素切割时由当前目标网格生成）。
+    // 切割任务持有引擎对象，重置毛坯时换成新对象
+    std::shared_ptr<VoxelCutEngine> voxelEngine_ = std::make_shared<VoxelCutEngine>();
+    
+    // 三向 Dexel 切割引擎（毛坯在第一次 Dexel 切割时由当前目标网格生成）
+    std::shared_ptr<DexelEngine> dexelEngine_ = std::make_shared<DexelEngine>();
+    
+    // 后台布尔运算工作器
+    BooleanWorker* cutWorker_ = nullptr;
+    quint64 pendingCutId_ = 0;
+    
+    // 推测性切割：圆柱体停止移动一段时间后，在后台以低优先级预先计算切割
+    QTimer* speculativeTimer_ = nullptr;
+    quint64 speculativeJobId_ = 0;
+    std::shared_ptr<BooleanResult> speculativeResult_;
+    MR::Vector3f speculativePosition_;
+    quint64 speculativeTargetVersion_ = 0;
+    
+    // 后台简化：每次提交切割后以低优先级简化切割新增的面，控制网格规模
+    CutSimplifier simplifier_;
+    quint64 simplifyJobId_ = 0;
+    quint64 simplifyTargetVersion_ = 0;
+    
+    // 后台压缩：简化之后（或无需简化时）压缩编号空洞并重排内存布局
+    quint64 compactJobId_ = 0;
+    quint64 compactTargetVersion_ = 0;
+    BooleanProfile compactProfile_;  // 尚未报告的压缩剖析数据
+    
+    // 位姿更新：合并同一轮事件中的多次输入框改变
+    QTimer* poseTimer_ = nullptr;
+    
+    // 切割历史（撤销/重做）
+    CutHistory cutHistory_;
+    QAction* undoAction_ = nullptr;
+    QAction* redoAction_ = nullptr;
+    
+    // 目标网格版本，每次加载或切割后递增
+    quint64 targetVersion_ = 0;
+    
+    // 目标网格及其持久化空间索引：切割任务持有快照，修改前写时复制
+    std::shared_ptr<PreparedTarget> preparedTarget_ = std::make_shared<PreparedTarget>();
+    
+    // 网格数据（写时复制句柄，与可视化器、空间索引、历史和切割缓存共享，不复制）
+    MeshHandle targetMesh_;
+    MeshHandle initialMesh_;  // 初始场景的长方体
+    MeshHandle cutterMesh_;
+    MeshHandle resultMesh_;
     
     // 目标网格包围盒
     MR::Box3f targetBoundingBox_;
     
-    // 圆柱体位置
+    // 目标网格的质量特性：加载时整体计算一次，之后每次切割只累加变化量
+    MassProperties massProps_;
+    double initialVolume_ = 0.0;        // 加载时的体积
+    double lastRemovedVolume_ = 0.0;    // 最近一次切割去除的体积
+    
+    // 圆柱体位置及对应的位姿（cutterMesh_ 始终位于规范位置）
     MR::Vector3f cutterPosition_;
+    MR::AffineXf3f cutterXf_;
+    
+    // 扫掠切割的起点：上次提交切割时的刀具位置（加载新模型后清除）
+    std::optional<MR::Vector3f> lastCutPosition_;
+    MR::Vector3f pendingCutPosition_;
     
     // UI 控件
     QDoubleSpinBox* spinX_ = nullptr;
@@ -132,10 +322,14 @@ private:
     QDoubleSpinBox* spinStep_ = nullptr;
     
     QPushButton* btnLoad_ = nullptr;
+    QAction* loadAction_ = nullptr;
     QPushButton* btnSave_ = nullptr;
     QPushButton* btnSavePiece_ = nullptr;
     QPushButton* btnCut_ = nullptr;
+    QCheckBox* chkSweep_ = nullptr;
     QPushButton* btnReset_ = nullptr;
+    QPushButton* btnCancel_ = nullptr;
+    QProgressBar* progressBar_ = nullptr;
     
     QPushButton* btnXPlus_ = nullptr;
     QPushButton* btnXMinus_ = nullptr;
@@ -145,10 +339,12 @@ private:
     QPushButton* btnZMinus_ = nullptr;
     
     QComboBox* comboVisualMode_ = nullptr;
+    QComboBox* comboEngine_ = nullptr;
+    QDoubleSpinBox* spinVoxelSize_ = nullptr;
     QLabel* infoLabel_ = nullptr;
     
     // 切割碎片网格
-    std::shared_ptr<MR::Mesh> cutPieceMesh_;
+    MeshHandle cutPieceMesh_;
     
     // 当前加载的文件路径
     QString currentFilePath_;
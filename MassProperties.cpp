@@ -0,0 +1,83 @@
+/**
+ * @file MassProperties.cpp
+ * @brief 网格质量特性实现
+ */
+
+#include "MassProperties.h"
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#include <algorithm>
+
+namespace
+{
+    /// 累加一个面的贡献：以原点为顶点的有向四面体，体积 v0·(v1×v2)/6，质心 (v0+v1+v2)/4
+    void addFace(const MR::Mesh& mesh, MR::FaceId f, MassProperties& sum)
+    {
+        MR::Vector3f a, b, c;
+        mesh.getTriPoints(f, a, b, c);
+        const MR::Vector3d v0(a), v1(b), v2(c);
+        const double tetVolume = MR::dot(v0, MR::cross(v1, v2)) / 6.0;
+        sum.volume += tetVolume;
+        sum.moment += (v0 + v1 + v2) * (tetVolume / 4.0);
+        sum.area += MR::cross(v1 - v0, v2 - v0).length() / 2.0;
+    }
+}
+
+MR::Vector3d MassProperties::centroid() const
+{
+    if (volume == 0.0)
+    {
+        return MR::Vector3d();
+    }
+    return moment / volume;
+}
+
+MassProperties MassProperties::compute(const MR::Mesh& mesh, const MR::FaceBitSet* region)
+{
+    // 区域（切割改动的面）只遍历置位的面，耗时与区域大小成正比
+    if (region)
+    {
+        MassProperties sum;
+        for (MR::FaceId f : *region)
+        {
+            if (mesh.topology.hasFace(f))
+            {
+                addFace(mesh, f, sum);
+            }
+        }
+        return sum;
+    }
+    
+    const MR::FaceBitSet& faces = mesh.topology.getValidFaces();
+    const size_t numFaces = std::min(faces.size(), size_t(mesh.topology.faceSize()));
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, numFaces), MassProperties(),
+        [&](const tbb::blocked_range<size_t>& range, MassProperties sum)
+        {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+            {
+                const MR::FaceId f(static_cast<int>(i));
+                if (faces.test(f))
+                {
+                    addFace(mesh, f, sum);
+                }
+            }
+            return sum;
+        },
+        [](MassProperties a, const MassProperties& b) { return a += b; });
+}
+
+MassProperties& MassProperties::operator+=(const MassProperties& other)
+{
+    volume += other.volume;
+    area += other.area;
+    moment += other.moment;
+    return *this;
+}
+
+MassProperties& MassProperties::operator-=(const MassProperties& other)
+{
+    volume -= other.volume;
+    area -= other.area;
+    moment -= other.moment;
+    return *this;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file MassProperties.h
+ * @brief 网格的体积、面积和质心
+ * 
+ * 由散度定理，封闭网格的体积和一阶矩是各三角面贡献之和，
+ * 因此切割后的变化量只需对被删除和新增的面求和
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRBitSet.h>
+#include <MRMesh/MRVector3.h>
+
+/**
+ * @brief 质量特性（按单位密度计）
+ * 
+ * 体积和一阶矩可直接相加减，质心由二者相除得到
+ */
+struct MassProperties
+{
+    double volume = 0.0;    ///< 体积 (mm^3)
+    double area = 0.0;      ///< 表面积 (mm^2)
+    MR::Vector3d moment;    ///< 一阶矩（体积加权的位置之和）
+    
+    /**
+     * @brief 质心，体积为零时返回原点
+     */
+    MR::Vector3d centroid() const;
+    
+    /**
+     * @brief 对网格的面求和
+     * @param region 只统计这些面（只遍历置位的面），为空时统计所有有效面
+     */
+    static MassProperties compute(const MR::Mesh& mesh, const MR::FaceBitSet* region = nullptr);
+    
+    MassProperties& operator+=(const MassProperties& other);
+    MassProperties& operator-=(const MassProperties& other);
+};
+
+inline MassProperties operator+(MassProperties a, const MassProperties& b) { return a += b; }
+inline MassProperties operator-(MassProperties a, const MassProperties& b) { return a -= b; }
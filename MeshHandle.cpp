@@ -0,0 +1,74 @@
+/**
+ * @file MeshHandle.cpp
+ * @brief 写时复制网格句柄实现
+ */
+
+#include "MeshHandle.h"
+#include <atomic>
+
+MeshHandle::Node::Node(MR::Mesh&& m)
+    : mesh(std::move(m))
+    , version(MeshHandle::nextVersion())
+{
+}
+
+MeshHandle::MeshHandle(MR::Mesh&& mesh)
+    : node_(std::make_shared<Node>(std::move(mesh)))
+{
+}
+
+uint64_t MeshHandle::nextVersion()
+{
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+}
+
+MR::Mesh& MeshHandle::edit()
+{
+    if (!node_)
+    {
+        node_ = std::make_shared<Node>(MR::Mesh());
+    }
+    else if (node_.use_count() > 1)
+    {
+        // 其他持有者仍在使用这份数据：复制后再修改
+        node_ = std::make_shared<Node>(MR::Mesh(node_->mesh));
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(node_->mutex);
+        node_->version = nextVersion();
+        node_->box.reset();
+    }
+    return node_->mesh;
+}
+
+MR::Mesh MeshHandle::take()
+{
+    if (!node_)
+    {
+        return MR::Mesh();
+    }
+    
+    std::shared_ptr<Node> node = std::move(node_);
+    if (node.use_count() > 1)
+    {
+        return node->mesh;
+    }
+    return std::move(node->mesh);
+}
+
+MR::Box3f MeshHandle::boundingBox() const
+{
+    if (!node_)
+    {
+        return MR::Box3f();
+    }
+    
+    std::lock_guard<std::mutex> lock(node_->mutex);
+    if (!node_->box)
+    {
+        node_->box = node_->mesh.computeBoundingBox();
+    }
+    return *node_->box;
+}
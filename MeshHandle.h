@@ -0,0 +1,100 @@
+/**
+ * @file MeshHandle.h
+ * @brief 带版本号的写时复制网格句柄
+ * 
+ * 句柄之间复制只增加引用计数，多个持有者（主窗口、布尔运算结果、切割缓存、可视化器）
+ * 共享同一份网格数据。通过 edit() 修改时，若数据还被其他句柄共享则先复制一份，
+ * 其他持有者看到的网格永远不会被改变。每份数据都有全局唯一、单调递增的版本号，
+ * 比较版本号即可判断网格是否改变；包围盒等派生数据按版本缓存
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRBox.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+/**
+ * @brief 写时复制网格句柄
+ * 
+ * 读取是线程安全的；edit() 只能由唯一的写入方调用，且调用期间不能有其他线程读取同一个句柄
+ */
+class MeshHandle
+{
+public:
+    MeshHandle() = default;
+    
+    /**
+     * @brief 接管网格（移动，不复制），分配新的版本号
+     */
+    MeshHandle(MR::Mesh&& mesh);
+    
+    /**
+     * @brief 是否持有网格
+     */
+    explicit operator bool() const { return bool(node_); }
+    
+    /**
+     * @brief 没有网格或网格没有顶点
+     */
+    bool empty() const { return !node_ || node_->mesh.points.empty(); }
+    
+    const MR::Mesh* get() const { return node_ ? &node_->mesh : nullptr; }
+    const MR::Mesh& operator*() const { return node_->mesh; }
+    const MR::Mesh* operator->() const { return &node_->mesh; }
+    
+    /**
+     * @brief 版本号，没有网格时为 0；两个句柄版本号相同当且仅当共享同一份未被修改的数据
+     */
+    uint64_t version() const { return node_ ? node_->version : 0; }
+    
+    /**
+     * @brief 取得可写的网格：数据被共享时先复制，之后分配新的版本号并清除派生数据
+     * 
+     * 修改完成前不要读取派生数据（boundingBox）；修改拓扑或坐标后仍需调用 invalidateCaches()
+     */
+    MR::Mesh& edit();
+    
+    /**
+     * @brief 取出网格并释放句柄：唯一持有时移动，否则复制
+     */
+    MR::Mesh take();
+    
+    /**
+     * @brief 包围盒，每个版本只计算一次
+     */
+    MR::Box3f boundingBox() const;
+    
+    /**
+     * @brief 网格数据占用的堆内存（共享的数据在每个持有者处都计入）
+     */
+    size_t heapBytes() const { return node_ ? node_->mesh.heapBytes() : 0; }
+    
+    /**
+     * @brief 释放网格
+     */
+    void reset() { node_.reset(); }
+
+private:
+    /**
+     * @brief 共享的网格数据及其派生数据
+     */
+    struct Node
+    {
+        explicit Node(MR::Mesh&& m);
+        
+        MR::Mesh mesh;
+        uint64_t version = 0;
+        
+        mutable std::mutex mutex;               ///< 保护派生数据的惰性计算
+        mutable std::optional<MR::Box3f> box;   ///< 包围盒
+    };
+    
+    static uint64_t nextVersion();
+    
+    std::shared_ptr<Node> node_;
+};
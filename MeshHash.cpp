@@ -0,0 +1,77 @@
+/**
+ * @file MeshHash.cpp
+ * @brief 网格内容哈希实现
+ */
+
+#include "MeshHash.h"
+#include <bit>
+#include <cmath>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+namespace
+{
+    /**
+     * @brief splitmix64 混合函数
+     */
+    uint64_t mix(uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+    
+    uint64_t combine(uint64_t h, uint64_t v)
+    {
+        return mix(h ^ v);
+    }
+}
+
+uint64_t MeshHash::faceHash(const MR::Mesh& mesh, MR::FaceId f)
+{
+    MR::Vector3f v[3];
+    mesh.getTriPoints(f, v[0], v[1], v[2]);
+    
+    uint64_t h = mix(static_cast<uint64_t>(int(f)));
+    for (const auto& p : v)
+    {
+        h = combine(h, std::bit_cast<uint32_t>(p.x));
+        h = combine(h, std::bit_cast<uint32_t>(p.y));
+        h = combine(h, std::bit_cast<uint32_t>(p.z));
+    }
+    return h;
+}
+
+uint64_t MeshHash::meshHash(const MR::Mesh& mesh)
+{
+    const MR::FaceBitSet& faces = mesh.topology.getValidFaces();
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, faces.size()), uint64_t(0),
+        [&](const tbb::blocked_range<size_t>& range, uint64_t sum)
+        {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+            {
+                const MR::FaceId f(static_cast<int>(i));
+                if (faces.test(f))
+                {
+                    sum += faceHash(mesh, f);
+                }
+            }
+            return sum;
+        },
+        [](uint64_t a, uint64_t b) { return a + b; });
+}
+
+uint64_t MeshHash::cutterHash(const MR::Mesh& mesh, const MR::AffineXf3f* xf, float quantum)
+{
+    // 刀具网格很小，顺序哈希即可；拓扑由面数和顶点数区分
+    uint64_t h = combine(mix(mesh.topology.numValidFaces()), mesh.topology.numValidVerts());
+    for (MR::VertId v : mesh.topology.getValidVerts())
+    {
+        const MR::Vector3f p = xf ? (*xf)(mesh.points[v]) : mesh.points[v];
+        h = combine(h, static_cast<uint64_t>(std::llround(p.x / quantum)));
+        h = combine(h, static_cast<uint64_t>(std::llround(p.y / quantum)));
+        h = combine(h, static_cast<uint64_t>(std::llround(p.z / quantum)));
+    }
+    return h;
+}
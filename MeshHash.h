@@ -0,0 +1,33 @@
+/**
+ * @file MeshHash.h
+ * @brief 网格内容哈希
+ * 
+ * 网格哈希是各面哈希之和（模 2^64），与求和顺序无关，
+ * 因此切割后只需减去被删除面的哈希、加上新增面的哈希即可增量更新
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRAffineXf3.h>
+#include <cstdint>
+
+namespace MeshHash
+{
+    /**
+     * @brief 单个面的哈希（包含面编号和三个顶点的坐标）
+     */
+    uint64_t faceHash(const MR::Mesh& mesh, MR::FaceId f);
+    
+    /**
+     * @brief 整个网格的哈希，等于所有有效面的 faceHash 之和
+     */
+    uint64_t meshHash(const MR::Mesh& mesh);
+    
+    /**
+     * @brief 刀具网格的哈希，顶点坐标经 xf 变换后按 quantum 量化，
+     *        位姿的微小浮点误差不会改变结果
+     * @param xf 可选，刀具位姿
+     */
+    uint64_t cutterHash(const MR::Mesh& mesh, const MR::AffineXf3f* xf, float quantum);
+}
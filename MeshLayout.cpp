@@ -0,0 +1,229 @@
+/**
+ * @file MeshLayout.cpp
+ * @brief 网格内存布局实现
+ */
+
+#include "MeshLayout.h"
+#include "AllocationCounter.h"
+#include <MRMesh/MRBuffer.h>
+#include <MRMesh/MRRingIterator.h>
+#include <MRMesh/MRParallelFor.h>
+#include <MRMesh/MRBox.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief 组相联 LRU 缓存模拟器
+     */
+    class CacheSimulator
+    {
+    public:
+        void access(const void* address)
+        {
+            const uintptr_t line = reinterpret_cast<uintptr_t>(address) / kLineBytes + 1;
+            auto& ways = sets_[line % kSets];
+            ++accesses_;
+            
+            // 命中的行移到最前，缺失时淘汰最后一行
+            auto it = std::find(ways.begin(), ways.end(), line);
+            if (it == ways.end())
+            {
+                ++misses_;
+                it = ways.end() - 1;
+            }
+            std::rotate(ways.begin(), it, it + 1);
+            ways.front() = line;
+        }
+        
+        MeshLayout::Locality result() const { return {accesses_, misses_}; }
+    
+    private:
+        static constexpr size_t kLineBytes = 64;
+        static constexpr size_t kWays = 8;
+        static constexpr size_t kSets = (32 << 10) / kLineBytes / kWays;
+        
+        std::array<std::array<uintptr_t, kWays>, kSets> sets_ = {};
+        size_t accesses_ = 0;
+        size_t misses_ = 0;
+    };
+    
+    /// 把 21 位整数的各位间隔两位展开
+    uint64_t spreadBits(uint64_t x)
+    {
+        x &= 0x1fffff;
+        x = (x | (x << 32)) & 0x1f00000000ffffull;
+        x = (x | (x << 16)) & 0x1f0000ff0000ffull;
+        x = (x | (x << 8)) & 0x100f00f00f00f00full;
+        x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+        x = (x | (x << 2)) & 0x1249249249249249ull;
+        return x;
+    }
+    
+    /// 包围盒内点的 Morton 码（每轴 21 位）
+    uint64_t mortonCode(const MR::Vector3f& p, const MR::Box3f& box)
+    {
+        const MR::Vector3f size = box.size();
+        auto quantize = [](float t, float extent)
+        {
+            if (extent <= 0.0f)
+            {
+                return uint64_t(0);
+            }
+            return static_cast<uint64_t>(std::clamp(t / extent, 0.0f, 1.0f) * float(0x1fffff));
+        };
+        const MR::Vector3f d = p - box.min;
+        return spreadBits(quantize(d.x, size.x)) |
+               (spreadBits(quantize(d.y, size.y)) << 1) |
+               (spreadBits(quantize(d.z, size.z)) << 2);
+    }
+    
+    /// 清空编号映射：所有旧编号都映射为无效编号
+    template <typename I>
+    void resetMap(MR::BMap<I, I>& map, size_t size)
+    {
+        map.b.resize(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            map.b[I(int(i))] = I();
+        }
+        map.tsize = 0;
+    }
+    
+    /// 尚未编号的元素取下一个新编号
+    template <typename I>
+    void assignNext(MR::BMap<I, I>& map, I id)
+    {
+        if (!map.b[id])
+        {
+            map.b[id] = I(int(map.tsize++));
+        }
+    }
+}
+
+MeshLayout::Locality MeshLayout::measureLocality(const MR::Mesh& mesh)
+{
+    CacheSimulator cache;
+    const MR::MeshTopology& topology = mesh.topology;
+    const auto& edgePerFace = topology.edgePerFace();
+    for (MR::FaceId f : topology.getValidFaces())
+    {
+        cache.access(&edgePerFace[f]);
+        for (MR::VertId v : topology.getTriVerts(f))
+        {
+            cache.access(&mesh.points[v]);
+        }
+    }
+    return cache.result();
+}
+
+float MeshLayout::holeRatio(const MR::Mesh& mesh)
+{
+    const MR::MeshTopology& topology = mesh.topology;
+    auto ratio = [](size_t valid, size_t slots)
+    {
+        return slots > 0 ? 1.0f - float(valid) / float(slots) : 0.0f;
+    };
+    return std::max(ratio(topology.numValidFaces(), topology.faceSize()),
+                    ratio(topology.numValidVerts(), topology.vertSize()));
+}
+
+MR::Mesh MeshLayout::compact(const MR::Mesh& mesh)
+{
+    const MR::MeshTopology& topology = mesh.topology;
+    const MR::Box3f box = mesh.computeBoundingBox();
+    
+    // 面按中心的 Morton 码排序
+    std::vector<std::pair<uint64_t, MR::FaceId>> order;
+    order.reserve(topology.numValidFaces());
+    for (MR::FaceId f : topology.getValidFaces())
+    {
+        order.push_back({0, f});
+    }
+    MR::ParallelFor(size_t(0), order.size(), [&](size_t i)
+    {
+        order[i].first = mortonCode(mesh.triCenter(order[i].second), box);
+    });
+    tbb::parallel_sort(order.begin(), order.end());
+    
+    // 顶点和边按排序后的面首次访问的顺序编号；
+    // 不与任何面相邻的顶点和边排在最后，拓扑原样保留
+    MR::PackMapping map;
+    resetMap(map.f, topology.faceSize());
+    resetMap(map.v, topology.vertSize());
+    resetMap(map.e, topology.undirectedEdgeSize());
+    for (const auto& [code, f] : order)
+    {
+        assignNext(map.f, f);
+        for (MR::EdgeId e : MR::leftRing(topology, f))
+        {
+            assignNext(map.e, e.undirected());
+            assignNext(map.v, topology.org(e));
+        }
+    }
+    for (MR::VertId v : topology.getValidVerts())
+    {
+        assignNext(map.v, v);
+    }
+    for (int i = 0; i < static_cast<int>(topology.undirectedEdgeSize()); ++i)
+    {
+        const MR::UndirectedEdgeId ue(i);
+        if (!topology.isLoneEdge(ue))
+        {
+            assignNext(map.e, ue);
+        }
+    }
+    
+    MR::Mesh result;
+    result.topology = topology;
+    result.topology.pack(map);
+    result.points.resize(map.v.tsize);
+    for (MR::VertId v : topology.getValidVerts())
+    {
+        result.points[map.v.b[v]] = mesh.points[v];
+    }
+    return result;
+}
+
+BooleanResult MeshLayout::optimize(const MR::Mesh& mesh, const MR::ProgressCallback& cb)
+{
+    BooleanResult result;
+    BooleanProfile& profile = result.profile;
+    
+    const Locality before = measureLocality(mesh);
+    if (!MR::reportProgress(cb, 0.2f))
+    {
+        result.errorMsg = BooleanOperator::kCanceledMsg;
+        return result;
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    const size_t allocations = AllocationCounter::count();
+    result.mesh = compact(mesh);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    profile.compact.ms = static_cast<float>(elapsed.count());
+    profile.compact.allocations = AllocationCounter::count() - allocations;
+    if (!MR::reportProgress(cb, 0.8f))
+    {
+        result.mesh.reset();
+        result.errorMsg = BooleanOperator::kCanceledMsg;
+        return result;
+    }
+    
+    // 面数不变，重排前后的访问次数相同
+    const Locality after = measureLocality(*result.mesh);
+    profile.cacheAccesses = before.accesses;
+    profile.cacheMissesBefore = before.misses;
+    profile.cacheMissesAfter = after.misses;
+    result.durationMs = profile.compact.ms;
+    result.success = true;
+    MR::reportProgress(cb, 1.0f);
+    
+    return result;
+}
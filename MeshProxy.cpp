@@ -0,0 +1,75 @@
+/**
+ * @file MeshProxy.cpp
+ * @brief 简化代理网格实现
+ */
+
+#include "MeshProxy.h"
+#include <MRMesh/MRMeshDecimate.h>
+#include <MRMesh/MRAABBTree.h>
+#include <algorithm>
+#include <cfloat>
+
+std::uint64_t MeshProxy::setSource(const MeshHandle& mesh)
+{
+    if (mesh.version() == source_.version())
+    {
+        return 0;
+    }
+    
+    const std::uint64_t stale = buildJob_;
+    source_ = mesh;
+    proxy_.reset();
+    buildJob_ = 0;
+    return stale;
+}
+
+bool MeshProxy::needsBuild() const
+{
+    return source_ && !proxy_ && buildJob_ == 0 &&
+           source_->topology.numValidFaces() > kFaceBudget;
+}
+
+bool MeshProxy::finishBuild(std::uint64_t jobId, const MeshHandle& proxy)
+{
+    if (jobId == 0 || jobId != buildJob_)
+    {
+        return false;
+    }
+    buildJob_ = 0;
+    proxy_ = proxy;
+    return true;
+}
+
+MeshHandle MeshProxy::get() const
+{
+    return proxy_ ? proxy_ : source_;
+}
+
+MeshHandle MeshProxy::build(const MR::Mesh& mesh, int faceBudget, const MR::ProgressCallback& cb)
+{
+    // 复制整个网格之前先检查一次取消
+    if (!MR::reportProgress(cb, 0.0f))
+    {
+        return {};
+    }
+    
+    MR::Mesh proxy = mesh;
+    
+    MR::DecimateSettings settings;
+    settings.strategy = MR::DecimateStrategy::MinimizeError;
+    settings.maxError = FLT_MAX;
+    settings.maxDeletedFaces = std::max(0, mesh.topology.numValidFaces() - faceBudget);
+    settings.packMesh = true;
+    settings.progressCallback = cb;
+    
+    const MR::DecimateResult decimated = MR::decimateMesh(proxy, settings);
+    if (decimated.cancelled)
+    {
+        return {};
+    }
+    
+    // 绘制时用于视锥剔除，在后台建好
+    MeshHandle handle(std::move(proxy));
+    handle->getAABBTree();
+    return handle;
+}
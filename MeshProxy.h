@@ -0,0 +1,75 @@
+/**
+ * @file MeshProxy.h
+ * @brief 交互时绘制的简化代理网格
+ * 
+ * 拖动旋转、滚轮缩放和移动刀具时每帧都要重绘，绘制耗时随面数增长。
+ * 网格改变并稳定一段时间后在后台把它简化到固定的面数预算以内，交互期间绘制代理，
+ * 停止交互后再绘制原网格，交互帧的耗时因此与原网格大小无关
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRProgressCallback.h>
+#include <cstdint>
+#include "MeshHandle.h"
+
+/**
+ * @brief 简化代理网格
+ * 
+ * 只保存源网格、代理和正在运行的构建任务编号，只在 GUI 线程中访问；
+ * 构建由调用方在后台工作器中运行，结果按任务编号提交
+ */
+class MeshProxy
+{
+public:
+    static constexpr int kFaceBudget = 100000;  ///< 代理网格的最大面数
+    
+    MeshProxy() = default;
+    
+    MeshProxy(const MeshProxy&) = delete;
+    MeshProxy& operator=(const MeshProxy&) = delete;
+    
+    /**
+     * @brief 网格版本改变时丢弃旧代理并忘记正在运行的构建（不等待，其迟到的结果按编号丢弃）
+     * @return 被忘记的构建任务编号，没有时返回 0；调用方负责取消该任务
+     */
+    std::uint64_t setSource(const MeshHandle& mesh);
+    
+    /**
+     * @brief 当前源网格
+     */
+    const MeshHandle& source() const { return source_; }
+    
+    /**
+     * @brief 源网格面数超过预算，且代理既未就绪也未在构建
+     */
+    bool needsBuild() const;
+    
+    /**
+     * @brief 记录为当前源网格构建代理的任务编号
+     */
+    void startBuild(std::uint64_t jobId) { buildJob_ = jobId; }
+    
+    /**
+     * @brief 提交构建结果：任务编号与当前构建一致时保存代理（失败时为空句柄）
+     * @return 结果属于当前源网格时返回 true
+     */
+    bool finishBuild(std::uint64_t jobId, const MeshHandle& proxy);
+    
+    /**
+     * @brief 当前网格的代理；面数不超过预算或代理尚未就绪时返回原网格
+     */
+    MeshHandle get() const;
+    
+    /**
+     * @brief 把网格简化到 faceBudget 个面以内（只受面数限制，不限几何误差），并构建 AABB 树
+     * @return 被取消时返回空句柄
+     */
+    static MeshHandle build(const MR::Mesh& mesh, int faceBudget, const MR::ProgressCallback& cb = {});
+
+private:
+    MeshHandle source_;
+    MeshHandle proxy_;
+    std::uint64_t buildJob_ = 0;
+};
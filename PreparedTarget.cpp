@@ -0,0 +1,243 @@
+/**
+ * @file PreparedTarget.cpp
+ * @brief 预处理的目标网格实现
+ */
+
+#include "PreparedTarget.h"
+#include "MeshHash.h"
+#include <MRMesh/MRAABBTree.h>
+#include <MRMesh/MRBitSetParallelFor.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    // 每个索引单元的目标面数
+    constexpr int kFacesPerCell = 256;
+    // 每个轴向的最大单元数
+    constexpr int kMaxCellsPerAxis = 64;
+}
+
+PreparedTarget::~PreparedTarget()
+{
+    wait();
+}
+
+PreparedTarget::PreparedTarget(const PreparedTarget& other)
+{
+    other.wait();
+    mesh_ = other.mesh_;
+    gridBox_ = other.gridBox_;
+    dims_ = other.dims_;
+    cellSize_ = other.cellSize_;
+    cells_ = other.cells_;
+    faceCell_ = other.faceCell_;
+    faceHash_ = other.faceHash_;
+    hash_ = other.hash_;
+}
+
+void PreparedTarget::reset(const MeshHandle& mesh)
+{
+    // 等待上一次构建结束，避免与后台线程竞争
+    wait();
+    
+    mesh_ = mesh;
+    ready_ = std::async(std::launch::async, [this]() { build(); }).share();
+}
+
+void PreparedTarget::detachMesh()
+{
+    wait();
+    mesh_.reset();
+}
+
+void PreparedTarget::applyCut(const MeshHandle& mesh,
+                              const MR::FaceBitSet& removedFaces,
+                              const MR::FaceBitSet& addedFaces)
+{
+    wait();
+    
+    if (cells_.empty())
+    {
+        reset(mesh);
+        return;
+    }
+    
+    mesh_ = mesh;
+    
+    // 记录受影响的单元，同时从内容哈希中减去被删除的面
+    std::vector<int> dirtyCells;
+    for (MR::FaceId f : removedFaces)
+    {
+        if (f < faceCell_.size() && faceCell_[f] >= 0)
+        {
+            dirtyCells.push_back(faceCell_[f]);
+            faceCell_[f] = -1;
+            hash_ -= faceHash_[f];
+            faceHash_[f] = 0;
+        }
+    }
+    
+    std::sort(dirtyCells.begin(), dirtyCells.end());
+    dirtyCells.erase(std::unique(dirtyCells.begin(), dirtyCells.end()), dirtyCells.end());
+    
+    // 从受影响的单元中移除被删除的面
+    for (int c : dirtyCells)
+    {
+        auto& faces = cells_[c].faces;
+        faces.erase(std::remove_if(faces.begin(), faces.end(),
+                                   [&](MR::FaceId f) { return removedFaces.test(f); }),
+                    faces.end());
+    }
+    
+    // 插入新增的面（包围盒在插入时扩展）
+    for (MR::FaceId f : addedFaces)
+    {
+        insertFace(f);
+        const uint64_t h = MeshHash::faceHash(*mesh_, f);
+        faceHash_.autoResizeSet(f, h, 0);
+        hash_ += h;
+    }
+    
+    // 只重新拟合面被删除过的单元
+    for (int c : dirtyCells)
+    {
+        refitCell(cells_[c]);
+    }
+}
+
+bool PreparedTarget::isReady() const
+{
+    return !ready_.valid() ||
+           ready_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void PreparedTarget::wait() const
+{
+    if (ready_.valid())
+    {
+        ready_.wait();
+    }
+}
+
+uint64_t PreparedTarget::contentHash() const
+{
+    wait();
+    return hash_;
+}
+
+MR::FaceBitSet PreparedTarget::findFacesInBox(const MR::Box3f& box) const
+{
+    wait();
+    
+    MR::FaceBitSet result;
+    if (!mesh_)
+    {
+        return result;
+    }
+    
+    result.resize(mesh_->topology.faceSize());
+    for (const auto& cell : cells_)
+    {
+        if (!cell.box.valid() || !box.intersects(cell.box))
+        {
+            continue;
+        }
+        for (MR::FaceId f : cell.faces)
+        {
+            if (box.intersects(faceBox(f)))
+            {
+                result.set(f);
+            }
+        }
+    }
+    
+    return result;
+}
+
+void PreparedTarget::build()
+{
+    cells_.clear();
+    faceCell_.clear();
+    faceHash_.clear();
+    hash_ = 0;
+    
+    if (!mesh_ || mesh_->points.empty())
+    {
+        return;
+    }
+    
+    // 同时预热 MeshLib 自身缓存的 AABB 树。只对加载时的网格有效：之后每次切割
+    // 得到新的网格，applyCut() 只更新均匀网格，全局布尔运算仍要重建整棵树
+    mesh_->getAABBTree();
+    
+    gridBox_ = mesh_.boundingBox();
+    
+    // 根据面数确定网格分辨率
+    const int numFaces = mesh_->topology.numValidFaces();
+    const int numCells = std::max(1, numFaces / kFacesPerCell);
+    const int res = std::clamp(static_cast<int>(std::cbrt(static_cast<float>(numCells))), 1, kMaxCellsPerAxis);
+    dims_ = MR::Vector3i(res, res, res);
+    
+    const MR::Vector3f size = gridBox_.size();
+    cellSize_ = MR::Vector3f(std::max(size.x / res, 1e-6f),
+                             std::max(size.y / res, 1e-6f),
+                             std::max(size.z / res, 1e-6f));
+    
+    cells_.resize(static_cast<size_t>(res) * res * res);
+    faceCell_.resize(mesh_->topology.faceSize(), -1);
+    
+    for (MR::FaceId f : mesh_->topology.getValidFaces())
+    {
+        insertFace(f);
+    }
+    
+    // 内容哈希是各面哈希之和，与 MeshHash::meshHash 一致
+    faceHash_.resize(mesh_->topology.faceSize(), 0);
+    MR::BitSetParallelFor(mesh_->topology.getValidFaces(), [&](MR::FaceId f)
+    {
+        faceHash_[f] = MeshHash::faceHash(*mesh_, f);
+    });
+    for (MR::FaceId f : mesh_->topology.getValidFaces())
+    {
+        hash_ += faceHash_[f];
+    }
+}
+
+int PreparedTarget::cellIndexOf(MR::FaceId f) const
+{
+    const MR::Vector3f rel = mesh_->triCenter(f) - gridBox_.min;
+    const int ix = std::clamp(static_cast<int>(rel.x / cellSize_.x), 0, dims_.x - 1);
+    const int iy = std::clamp(static_cast<int>(rel.y / cellSize_.y), 0, dims_.y - 1);
+    const int iz = std::clamp(static_cast<int>(rel.z / cellSize_.z), 0, dims_.z - 1);
+    return (iz * dims_.y + iy) * dims_.x + ix;
+}
+
+void PreparedTarget::insertFace(MR::FaceId f)
+{
+    const int c = cellIndexOf(f);
+    cells_[c].faces.push_back(f);
+    cells_[c].box.include(faceBox(f));
+    faceCell_.autoResizeSet(f, c, -1);
+}
+
+void PreparedTarget::refitCell(Cell& cell) const
+{
+    cell.box = MR::Box3f();
+    for (MR::FaceId f : cell.faces)
+    {
+        cell.box.include(faceBox(f));
+    }
+}
+
+MR::Box3f PreparedTarget::faceBox(MR::FaceId f) const
+{
+    MR::Vector3f v0, v1, v2;
+    mesh_->getTriPoints(f, v0, v1, v2);
+    MR::Box3f box;
+    box.include(v0);
+    box.include(v1);
+    box.include(v2);
+    return box;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file PreparedTarget.h
+ * @brief 预处理的目标网格
+ * 
+ * 持有目标网格及其空间索引，索引在加载后于后台构建一次，
+ * 之后每次切割只更新被切割影响到的单元
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRBox.h>
+#include <MRMesh/MRBitSet.h>
+#include <MRMesh/MRVector.h>
+#include "MeshHandle.h"
+#include <cstdint>
+#include <future>
+#include <vector>
+
+/**
+ * @brief 预处理的目标网格类
+ * 
+ * 空间索引是覆盖网格包围盒的均匀网格，每个单元记录中心落在其中的面
+ * 以及这些面的包围盒并集。切割后只需从受影响的单元中移除被删除的面、
+ * 插入新增的面，并重新拟合这些单元的包围盒。
+ * 
+ * 窗口选面和位置分类用均匀网格代替 AABB 树的增量拟合；MeshLib 的 AABB 树
+ * 不随切割更新，退回全局布尔运算（扫掠、窗口失败、批量切割）时仍需整体重建
+ */
+class PreparedTarget
+{
+public:
+    PreparedTarget() = default;
+    ~PreparedTarget();
+    
+    /**
+     * @brief 复制网格句柄和空间索引（先等待 other 的后台构建结束），
+     *        后台任务仍在读取旧索引时用于写时复制
+     */
+    PreparedTarget(const PreparedTarget& other);
+    PreparedTarget& operator=(const PreparedTarget&) = delete;
+    
+    /**
+     * @brief 设置新的目标网格，并在后台构建空间索引
+     */
+    void reset(const MeshHandle& mesh);
+    
+    /**
+     * @brief 切割后增量更新空间索引
+     * @param mesh 切割后的网格（未被删除的面保持原编号）
+     * @param removedFaces 切割删除的面（旧网格编号）
+     * @param addedFaces 切割新增的面（新网格编号）
+     */
+    void applyCut(const MeshHandle& mesh,
+                  const MR::FaceBitSet& removedFaces,
+                  const MR::FaceBitSet& addedFaces);
+    
+    /**
+     * @brief 获取当前目标网格
+     */
+    const MeshHandle& getMesh() const { return mesh_; }
+    
+    /**
+     * @brief 释放对当前网格的引用（索引保留），调用方随后可以就地修改网格，
+     *        修改后必须调用 applyCut() 或 reset()
+     */
+    void detachMesh();
+    
+    /**
+     * @brief 空间索引是否已构建完成
+     */
+    bool isReady() const;
+    
+    /**
+     * @brief 等待后台构建完成
+     */
+    void wait() const;
+    
+    /**
+     * @brief 查询三角形包围盒与 box 相交的所有面
+     */
+    MR::FaceBitSet findFacesInBox(const MR::Box3f& box) const;
+    
+    /**
+     * @brief 目标网格的内容哈希（MeshHash::meshHash），随切割增量更新
+     */
+    uint64_t contentHash() const;
+
+private:
+    /**
+     * @brief 索引单元
+     */
+    struct Cell
+    {
+        MR::Box3f box;                  ///< 单元内所有面的包围盒并集
+        std::vector<MR::FaceId> faces;  ///< 中心落在单元内的面
+    };
+    
+    void build();
+    int cellIndexOf(MR::FaceId f) const;
+    void insertFace(MR::FaceId f);
+    void refitCell(Cell& cell) const;
+    MR::Box3f faceBox(MR::FaceId f) const;
+    
+    MeshHandle mesh_;
+    
+    // 均匀网格参数
+    MR::Box3f gridBox_;
+    MR::Vector3i dims_;
+    MR::Vector3f cellSize_;
+    std::vector<Cell> cells_;
+    MR::Vector<int, MR::FaceId> faceCell_;  ///< 每个面所在的单元编号
+    
+    // 内容哈希：保存每个面的哈希，切割后只减去删除的面、加上新增的面
+    MR::Vector<uint64_t, MR::FaceId> faceHash_;
+    uint64_t hash_ = 0;
+    
+    // 后台构建任务
+    std::shared_future<void> ready_;
+};
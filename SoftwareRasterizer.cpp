@@ -0,0 +1,540 @@
+/**
+ * @file SoftwareRasterizer.cpp
+ * @brief 分块多线程软件光栅化器实现
+ */
+
+#include "SoftwareRasterizer.h"
+#include <MRMesh/MRAABBTree.h>
+#include <MRMesh/MRBitSetParallelFor.h>
+#include <MRMesh/MRParallelFor.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+namespace
+{
+    constexpr size_t kFacesPerBatch = 16384;  ///< 并行处理面时每个批次的面数下限
+    
+    /// 并行批次数：批次足够多以便负载均衡，每批又不至于太小
+    size_t batchCount(size_t numFaces)
+    {
+        const size_t maxBatches = std::max<size_t>(1, size_t(std::thread::hardware_concurrency()) * 4);
+        return std::clamp<size_t>(numFaces / kFacesPerBatch, 1, maxBatches);
+    }
+    
+    /// 平面着色：法向越接近视线方向越亮
+    QRgb shade(const MR::Vector3f& a, const MR::Vector3f& b, const MR::Vector3f& c, const QColor& color)
+    {
+        const MR::Vector3f n = MR::cross(b - a, c - a);
+        const float len = n.length();
+        const float facing = len > 0.0f ? std::abs(n.z) / len : 0.0f;
+        const float k = 0.3f + 0.7f * facing;
+        return qRgb(int(color.red() * k), int(color.green() * k), int(color.blue() * k));
+    }
+    
+    /// 以不透明度 alpha 把不透明颜色 src 叠加到预乘颜色 dst 上
+    QRgb blendOver(QRgb dst, QRgb src, float alpha)
+    {
+        const float keep = 1.0f - alpha;
+        return qRgba(int(qRed(src) * alpha + qRed(dst) * keep), int(qGreen(src) * alpha + qGreen(dst) * keep),
+                     int(qBlue(src) * alpha + qBlue(dst) * keep), int(255.0f * alpha + qAlpha(dst) * keep));
+    }
+    
+    /// 把预乘颜色 src 叠加到不透明颜色 dst 上
+    QRgb compositeOver(QRgb dst, QRgb src)
+    {
+        const int keep = 255 - qAlpha(src);
+        return qRgb(qRed(src) + qRed(dst) * keep / 255, qGreen(src) + qGreen(dst) * keep / 255,
+                    qBlue(src) + qBlue(dst) * keep / 255);
+    }
+}
+
+RasterView::RasterView(float rotX, float rotY, float scale, const MR::Vector2f& center)
+    : cosX(std::cos(rotX))
+    , sinX(std::sin(rotX))
+    , cosY(std::cos(rotY))
+    , sinY(std::sin(rotY))
+    , scale(scale)
+    , center(center)
+{
+}
+
+MR::Box2f RasterView::screenBox(const MR::Box3f& box) const
+{
+    // 正交投影：中心照常投影，半尺寸乘以旋转矩阵各元素的绝对值
+    const MR::Vector3f c = toScreen(box.center());
+    const MR::Vector3f h = box.size() * 0.5f;
+    const float hx = (std::abs(cosY) * h.x + std::abs(sinX * sinY) * h.y + std::abs(cosX * sinY) * h.z) * scale;
+    const float hy = (std::abs(cosX) * h.y + std::abs(sinX) * h.z) * scale;
+    return MR::Box2f(MR::Vector2f(c.x - hx, c.y - hy), MR::Vector2f(c.x + hx, c.y + hy));
+}
+
+void SoftwareRasterizer::resize(int width, int height)
+{
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (image_.width() != width || image_.height() != height)
+    {
+        image_ = QImage(width, height, QImage::Format_RGB32);
+        tilesX_ = (width + kTileSize - 1) / kTileSize;
+        tilesY_ = (height + kTileSize - 1) / kTileSize;
+    }
+}
+
+void RenderCache::update(const MeshHandle& mesh)
+{
+    if (mesh.version() == version)
+    {
+        return;
+    }
+    version = mesh.version();
+    visible.clear();
+    if (!mesh)
+    {
+        tris.clear();
+        closed = false;
+        return;
+    }
+    
+    const MR::MeshTopology& topology = mesh->topology;
+    closed = topology.isClosed();
+    tris.assign(topology.faceSize(), MR::ThreeVertIds{});
+    MR::BitSetParallelFor(topology.getValidFaces(), [&](MR::FaceId f)
+    {
+        tris[f.get()] = topology.getTriVerts(f);
+    });
+}
+
+void RenderCache::project(const MR::Mesh& mesh, const RasterView& view, const MR::AffineXf3f* xf,
+                          const std::vector<uint32_t>* faces)
+{
+    const size_t numVerts = mesh.points.size();
+    x.resize(numVerts);
+    y.resize(numVerts);
+    z.resize(numVerts);
+    auto projectVert = [&](MR::VertId v)
+    {
+        const MR::Vector3f& p = mesh.points[v];
+        const MR::Vector3f s = view.toScreen(xf ? (*xf)(p) : p);
+        x[v.get()] = s.x;
+        y[v.get()] = s.y;
+        z[v.get()] = s.z;
+    };
+    
+    if (!faces)
+    {
+        MR::ParallelFor(size_t(0), numVerts, [&](size_t i)
+        {
+            projectVert(MR::VertId(int(i)));
+        });
+        return;
+    }
+    
+    // 先串行收集候选面的顶点（去重，且各线程不会写同一顶点），再并行投影；
+    // 其余顶点的屏幕坐标本帧不会被读取
+    projected.resize(numVerts);
+    projected.reset();
+    projectVerts.clear();
+    for (uint32_t f : *faces)
+    {
+        const MR::ThreeVertIds& tri = tris[f];
+        if (!tri[0].valid())
+        {
+            continue;
+        }
+        for (MR::VertId v : tri)
+        {
+            if (!projected.test_set(v))
+            {
+                projectVerts.push_back(v);
+            }
+        }
+    }
+    MR::ParallelFor(size_t(0), projectVerts.size(), [&](size_t i)
+    {
+        projectVert(projectVerts[i]);
+    });
+}
+
+void RenderCache::setTree(const MeshHandle& mesh)
+{
+    treeVersion = mesh.version();
+    tree = mesh ? mesh->getAABBTreeNotCreate() : nullptr;
+}
+
+void RenderCache::sortByDepth(bool backToFront)
+{
+    const size_t numFaces = visible.size();
+    keys.resize(numFaces);
+    MR::ParallelFor(size_t(0), numFaces, [&](size_t i)
+    {
+        const MR::ThreeVertIds& tri = tris[visible[i]];
+        const float depth = z[tri[0].get()] + z[tri[1].get()] + z[tri[2].get()];
+        
+        // 浮点数的位模式翻转后按无符号整数比较与按浮点比较的顺序一致
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        if (backToFront)
+        {
+            bits = ~bits;
+        }
+        keys[i] = (uint64_t(bits) << 32) | visible[i];
+    });
+    tbb::parallel_sort(keys.begin(), keys.end());
+    MR::ParallelFor(size_t(0), numFaces, [&](size_t i)
+    {
+        visible[i] = uint32_t(keys[i]);
+    });
+}
+
+bool SoftwareRasterizer::isCurrent(const RenderLayer& layer, const MeshHandle& mesh, const RasterView& view,
+                                   const QColor& color, float opacity, const MR::AffineXf3f* xf) const
+{
+    return layer.image.size() == image_.size() && layer.version == mesh.version() && layer.view == view &&
+           layer.xf == (xf ? *xf : MR::AffineXf3f()) && layer.color == color.rgb() && layer.opacity == opacity;
+}
+
+bool SoftwareRasterizer::renderLayer(RenderLayer& layer, const MeshHandle& mesh, RenderCache& cache,
+                                     const RasterView& view, const QColor& color, float opacity,
+                                     const MR::AffineXf3f* xf)
+{
+    if (image_.isNull() || isCurrent(layer, mesh, view, color, opacity, xf))
+    {
+        return false;
+    }
+    
+    layer.version = mesh.version();
+    layer.view = view;
+    layer.xf = xf ? *xf : MR::AffineXf3f();
+    layer.color = color.rgb();
+    layer.opacity = opacity;
+    if (layer.image.size() != image_.size())
+    {
+        layer.image = QImage(image_.size(), QImage::Format_ARGB32_Premultiplied);
+    }
+    layer.image.fill(Qt::transparent);
+    layer.depth.assign(size_t(image_.width()) * image_.height(), std::numeric_limits<float>::infinity());
+    
+    if (mesh.empty())
+    {
+        return true;
+    }
+    cache.update(mesh);
+    if (cache.tris.empty())
+    {
+        return true;
+    }
+    
+    // 只使用后台为当前版本建好的树，绘制线程既不构建也不读取可能正在构建的树
+    const MR::AABBTree* tree = cache.treeVersion == mesh.version() ? cache.tree : nullptr;
+    const bool useCandidates = cullFrustum(tree, view, xf);
+    cache.project(*mesh, view, xf, useCandidates ? &candidates_ : nullptr);
+    cullFaces(cache, useCandidates);
+    if (cache.visible.empty())
+    {
+        return true;
+    }
+    
+    // 半透明混合的结果与顺序有关，从远到近绘制；不透明网格由深度缓冲保证正确，无需排序
+    if (opacity < 1.0f)
+    {
+        cache.sortByDepth(true);
+    }
+    
+    binFaces(cache);
+    
+    // 各块写入互不重叠的像素，无需加锁；在主线程取得像素指针，避免工作线程触发 QImage 分离
+    QRgb* pixels = reinterpret_cast<QRgb*>(layer.image.bits());
+    float* depth = layer.depth.data();
+    MR::ParallelFor(0, tilesX_ * tilesY_, [&](int tile)
+    {
+        rasterizeTile(cache, tile, color, opacity, pixels, depth);
+    });
+    return true;
+}
+
+void SoftwareRasterizer::composite(const std::vector<const RenderLayer*>& layers, const QColor& background)
+{
+    const QRgb backgroundColor = background.rgb();
+    const int width = image_.width();
+    QRgb* pixels = reinterpret_cast<QRgb*>(image_.bits());
+    MR::ParallelFor(0, image_.height(), [&](int y)
+    {
+        const size_t rowStart = size_t(y) * width;
+        for (int x = 0; x < width; ++x)
+        {
+            const size_t idx = rowStart + x;
+            float nearest = std::numeric_limits<float>::infinity();
+            QRgb color = backgroundColor;
+            for (const RenderLayer* layer : layers)
+            {
+                if (layer->opacity >= 1.0f && layer->depth[idx] < nearest)
+                {
+                    nearest = layer->depth[idx];
+                    color = reinterpret_cast<const QRgb*>(layer->image.constBits())[idx];
+                }
+            }
+            for (const RenderLayer* layer : layers)
+            {
+                if (layer->opacity < 1.0f && layer->depth[idx] < nearest)
+                {
+                    color = compositeOver(color, reinterpret_cast<const QRgb*>(layer->image.constBits())[idx]);
+                }
+            }
+            pixels[idx] = color;
+        }
+    });
+}
+
+bool SoftwareRasterizer::cullFrustum(const MR::AABBTree* tree, const RasterView& view, const MR::AffineXf3f* xf)
+{
+    candidates_.clear();
+    
+    // 树还没在后台建好时不在绘制线程上构建（大网格构建耗时较长），逐面剔除即可
+    if (!tree || tree->nodes().empty())
+    {
+        return false;
+    }
+    
+    const MR::Box2f viewport(MR::Vector2f(0.0f, 0.0f), MR::Vector2f(float(image_.width()), float(image_.height())));
+    auto nodeBox = [&](MR::NodeId n)
+    {
+        const MR::Box3f& box = (*tree)[n].box;
+        return view.screenBox(xf ? MR::transformed(box, *xf) : box);
+    };
+    
+    // 整个网格都在视口内：不必遍历
+    const MR::Box2f rootBox = nodeBox(tree->rootNodeId());
+    if (viewport.contains(rootBox.min) && viewport.contains(rootBox.max))
+    {
+        return false;
+    }
+    
+    // 视口外的子树整体跳过，完全在视口内的子树不再测试，只收集叶子
+    stack_.clear();
+    stack_.push_back({tree->rootNodeId(), false});
+    while (!stack_.empty())
+    {
+        const auto [n, inside] = stack_.back();
+        stack_.pop_back();
+        const auto& node = (*tree)[n];
+        
+        bool nodeInside = inside;
+        if (!nodeInside)
+        {
+            const MR::Box2f box = nodeBox(n);
+            if (!box.intersects(viewport))
+            {
+                continue;
+            }
+            nodeInside = viewport.contains(box.min) && viewport.contains(box.max);
+        }
+        
+        if (node.leaf())
+        {
+            candidates_.push_back(uint32_t(node.leafId().get()));
+        }
+        else
+        {
+            stack_.push_back({node.r, nodeInside});
+            stack_.push_back({node.l, nodeInside});
+        }
+    }
+    return true;
+}
+
+void SoftwareRasterizer::cullFaces(RenderCache& cache, bool useCandidates)
+{
+    const size_t numFaces = useCandidates ? candidates_.size() : cache.tris.size();
+    const size_t numBatches = batchCount(numFaces);
+    survivors_.resize(numBatches);
+    
+    const float width = float(image_.width());
+    const float height = float(image_.height());
+    MR::ParallelFor(size_t(0), numBatches, [&](size_t batch)
+    {
+        auto& survivors = survivors_[batch];
+        survivors.clear();
+        
+        const size_t begin = numFaces * batch / numBatches;
+        const size_t end = numFaces * (batch + 1) / numBatches;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint32_t f = useCandidates ? candidates_[i] : uint32_t(i);
+            const MR::ThreeVertIds& tri = cache.tris[f];
+            if (!tri[0].valid())
+            {
+                continue;
+            }
+            
+            const MR::Vector3f a = cache.screenPoint(tri[0]);
+            const MR::Vector3f b = cache.screenPoint(tri[1]);
+            const MR::Vector3f c = cache.screenPoint(tri[2]);
+            
+            // 正交投影下屏幕上的绕向即朝向：外法向朝向观察者的面在屏幕（y 向下）上有向面积为正。
+            // 封闭网格剔除背面，开放网格的背面透过边界可见，只剔除退化的面
+            const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (cache.closed ? !(area > 0.0f) : !(std::abs(area) > 0.0f))
+            {
+                continue;
+            }
+            
+            // 完全在视口外（比较写成这样也能排除 NaN 坐标）
+            if (!(std::max({a.x, b.x, c.x}) >= 0.0f && std::max({a.y, b.y, c.y}) >= 0.0f &&
+                  std::min({a.x, b.x, c.x}) < width && std::min({a.y, b.y, c.y}) < height))
+            {
+                continue;
+            }
+            
+            survivors.push_back(f);
+        }
+    });
+    
+    cache.visible.clear();
+    for (const auto& survivors : survivors_)
+    {
+        cache.visible.insert(cache.visible.end(), survivors.begin(), survivors.end());
+    }
+}
+
+void SoftwareRasterizer::binFaces(const RenderCache& cache)
+{
+    const size_t numFaces = cache.visible.size();
+    const size_t numTiles = size_t(tilesX_) * tilesY_;
+    
+    // 按绘制顺序把面分成若干批次并行分配；每个块按批次顺序处理，保持绘制顺序且与线程调度无关
+    const size_t numBatches = batchCount(numFaces);
+    bins_.resize(numBatches);
+    for (auto& bins : bins_)
+    {
+        bins.resize(numTiles);
+    }
+    
+    const float width = float(image_.width());
+    const float height = float(image_.height());
+    MR::ParallelFor(size_t(0), numBatches, [&](size_t batch)
+    {
+        auto& bins = bins_[batch];
+        for (auto& bin : bins)
+        {
+            bin.clear();
+        }
+        
+        const size_t begin = numFaces * batch / numBatches;
+        const size_t end = numFaces * (batch + 1) / numBatches;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint32_t f = cache.visible[i];
+            const MR::ThreeVertIds& tri = cache.tris[f];
+            const int v0 = tri[0].get();
+            const int v1 = tri[1].get();
+            const int v2 = tri[2].get();
+            const float minX = std::max(std::min({cache.x[v0], cache.x[v1], cache.x[v2]}), 0.0f);
+            const float maxX = std::min(std::max({cache.x[v0], cache.x[v1], cache.x[v2]}), width - 1.0f);
+            const float minY = std::max(std::min({cache.y[v0], cache.y[v1], cache.y[v2]}), 0.0f);
+            const float maxY = std::min(std::max({cache.y[v0], cache.y[v1], cache.y[v2]}), height - 1.0f);
+            
+            const int tx0 = int(minX) / kTileSize;
+            const int tx1 = int(maxX) / kTileSize;
+            const int ty0 = int(minY) / kTileSize;
+            const int ty1 = int(maxY) / kTileSize;
+            for (int ty = ty0; ty <= ty1; ++ty)
+            {
+                for (int tx = tx0; tx <= tx1; ++tx)
+                {
+                    bins[size_t(ty) * tilesX_ + tx].push_back(f);
+                }
+            }
+        }
+    });
+}
+
+void SoftwareRasterizer::rasterizeTile(const RenderCache& cache, int tile, const QColor& color, float opacity,
+                                       QRgb* pixels, float* depth)
+{
+    const int width = image_.width();
+    const int x0 = (tile % tilesX_) * kTileSize;
+    const int y0 = (tile / tilesX_) * kTileSize;
+    const int x1 = std::min(x0 + kTileSize, width);
+    const int y1 = std::min(y0 + kTileSize, image_.height());
+    const bool opaque = opacity >= 1.0f;
+    
+    for (const auto& bins : bins_)
+    {
+        for (uint32_t f : bins[tile])
+        {
+            const MR::ThreeVertIds& tri = cache.tris[f];
+            const MR::Vector3f a = cache.screenPoint(tri[0]);
+            const MR::Vector3f b = cache.screenPoint(tri[1]);
+            const MR::Vector3f c = cache.screenPoint(tri[2]);
+            
+            // 有向面积为零的面已在剔除阶段排除
+            const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            
+            const int minX = std::max(x0, int(std::floor(std::min({a.x, b.x, c.x}))));
+            const int maxX = std::min(x1 - 1, int(std::ceil(std::max({a.x, b.x, c.x}))));
+            const int minY = std::max(y0, int(std::floor(std::min({a.y, b.y, c.y}))));
+            const int maxY = std::min(y1 - 1, int(std::ceil(std::max({a.y, b.y, c.y}))));
+            if (minX > maxX || minY > maxY)
+            {
+                continue;
+            }
+            
+            // 重心坐标是像素坐标的线性函数，沿行和列增量计算；除以有向面积后内部三者均非负，与绕向无关
+            const float invArea = 1.0f / area;
+            const float dx0 = (b.y - c.y) * invArea;
+            const float dy0 = (c.x - b.x) * invArea;
+            const float dx1 = (c.y - a.y) * invArea;
+            const float dy1 = (a.x - c.x) * invArea;
+            const float dx2 = (a.y - b.y) * invArea;
+            const float dy2 = (b.x - a.x) * invArea;
+            
+            const float px = minX + 0.5f;
+            const float py = minY + 0.5f;
+            float row0 = ((c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x)) * invArea;
+            float row1 = ((a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x)) * invArea;
+            float row2 = ((b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x)) * invArea;
+            
+            const QRgb faceColor = shade(a, b, c, color);
+            for (int y = minY; y <= maxY; ++y)
+            {
+                float l0 = row0;
+                float l1 = row1;
+                float l2 = row2;
+                const size_t rowStart = size_t(y) * width;
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    if (l0 >= 0.0f && l1 >= 0.0f && l2 >= 0.0f)
+                    {
+                        const float z = l0 * a.z + l1 * b.z + l2 * c.z;
+                        const size_t idx = rowStart + x;
+                        if (opaque)
+                        {
+                            if (z < depth[idx])
+                            {
+                                depth[idx] = z;
+                                pixels[idx] = faceColor;
+                            }
+                        }
+                        else
+                        {
+                            // 半透明层内部按从远到近的顺序叠加，深度记录最近的片元
+                            pixels[idx] = blendOver(pixels[idx], faceColor, opacity);
+                            depth[idx] = std::min(depth[idx], z);
+                        }
+                    }
+                    l0 += dx0;
+                    l1 += dx1;
+                    l2 += dx2;
+                }
+                row0 += dy0;
+                row1 += dy1;
+                row2 += dy2;
+            }
+        }
+    }
+}
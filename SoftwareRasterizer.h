@@ -0,0 +1,199 @@
+/**
+ * @file SoftwareRasterizer.h
+ * @brief 分块多线程软件光栅化器
+ * 
+ * 把视口划分为固定大小的块，三角形按屏幕包围盒分配到所覆盖的块中，
+ * 各块在不同线程上独立做深度测试和着色，互不加锁。结果写入 QImage，
+ * 由 CutterVisualizer::paintEvent 一次绘制到窗口
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRAffineXf3.h>
+#include <MRMesh/MRVector2.h>
+#include <MRMesh/MRBox.h>
+#include <MRMesh/MRId.h>
+#include <QColor>
+#include <QImage>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "MeshHandle.h"
+
+/**
+ * @brief 正交视图：先绕 X 轴、再绕 Y 轴旋转，然后缩放并平移到屏幕
+ */
+struct RasterView
+{
+    float cosX = 1.0f;
+    float sinX = 0.0f;
+    float cosY = 1.0f;
+    float sinY = 0.0f;
+    float scale = 1.0f;      ///< 每毫米的像素数
+    MR::Vector2f center;     ///< 世界原点在屏幕上的位置（像素）
+    
+    RasterView() = default;
+    RasterView(float rotX, float rotY, float scale, const MR::Vector2f& center);
+    
+    bool operator==(const RasterView&) const = default;
+    
+    /**
+     * @brief 世界坐标变换到屏幕：x、y 为像素坐标（y 向下），z 为以像素为单位的深度（越小越近）
+     */
+    MR::Vector3f toScreen(const MR::Vector3f& p) const
+    {
+        const float y1 = p.y * cosX - p.z * sinX;
+        const float z1 = p.y * sinX + p.z * cosX;
+        const float x2 = p.x * cosY + z1 * sinY;
+        const float z2 = -p.x * sinY + z1 * cosY;
+        return MR::Vector3f(center.x + x2 * scale, center.y - y1 * scale, z2 * scale);
+    }
+    
+    /**
+     * @brief 世界坐标包围盒在屏幕上的包围矩形（像素）
+     */
+    MR::Box2f screenBox(const MR::Box3f& box) const;
+};
+
+/**
+ * @brief 单个网格的渲染缓存
+ * 
+ * 三角形表（按面编号索引的顶点编号）只在网格版本改变时重建，之后每帧不再遍历拓扑；
+ * 顶点的屏幕坐标按结构数组（x、y、z 分开）存放，每帧每个顶点只投影一次，
+ * 有 AABB 树时只投影视锥剔除后留下的面的顶点。
+ * 所有缓冲区跨帧复用，网格不变时每帧不分配内存
+ */
+struct RenderCache
+{
+    /**
+     * @brief 网格版本改变时重建三角形表
+     */
+    void update(const MeshHandle& mesh);
+    
+    /**
+     * @brief 投影顶点到屏幕
+     * @param faces 只投影这些面的顶点，为空时投影所有顶点
+     */
+    void project(const MR::Mesh& mesh, const RasterView& view, const MR::AffineXf3f* xf,
+                 const std::vector<uint32_t>* faces = nullptr);
+    
+    /**
+     * @brief 发布网格的 AABB 树：必须在后台建好之后才调用，之后不再有线程写入该树
+     */
+    void setTree(const MeshHandle& mesh);
+    
+    /**
+     * @brief 按面中心深度排序 visible 中的面
+     * 
+     * 键为 8 字节：高 32 位是保序编码的深度，低 32 位是面编号，排序只移动整数
+     */
+    void sortByDepth(bool backToFront);
+    
+    /**
+     * @brief 顶点的屏幕坐标
+     */
+    MR::Vector3f screenPoint(MR::VertId v) const
+    {
+        return MR::Vector3f(x[v.get()], y[v.get()], z[v.get()]);
+    }
+    
+    uint64_t version = 0;                 ///< 三角形表对应的网格版本
+    uint64_t treeVersion = 0;             ///< tree 对应的网格版本
+    const MR::AABBTree* tree = nullptr;   ///< 后台建好的 AABB 树，只在 treeVersion 与网格版本一致时使用
+    bool closed = false;                  ///< 网格是否封闭（封闭时才剔除背面）
+    std::vector<MR::ThreeVertIds> tris;   ///< 三角形表，已删除的面顶点编号无效
+    std::vector<float> x;                 ///< 顶点屏幕横坐标（像素）
+    std::vector<float> y;                 ///< 顶点屏幕纵坐标（像素）
+    std::vector<float> z;                 ///< 顶点深度
+    MR::VertBitSet projected;             ///< 本帧已投影的顶点（只投影部分顶点时）
+    std::vector<MR::VertId> projectVerts; ///< 本帧需要投影的顶点（只投影部分顶点时）
+    std::vector<uint32_t> visible;        ///< 本帧通过剔除的面（绘制顺序）
+    std::vector<uint64_t> keys;           ///< 排序键
+};
+
+/**
+ * @brief 渲染层：一个网格单独光栅化的结果
+ * 
+ * 网格版本、视图、变换、颜色和不透明度都与上次相同时直接复用，
+ * 因此只移动刀具时只有刀具层需要重新光栅化，其余层只参与合成
+ */
+struct RenderLayer
+{
+    QImage image;              ///< 预乘 alpha 的颜色，没有片元的像素完全透明
+    std::vector<float> depth;  ///< 每个像素最近片元的深度，没有片元处为无穷远
+    
+    // 上次光栅化的条件
+    uint64_t version = 0;
+    RasterView view;
+    MR::AffineXf3f xf;
+    QRgb color = 0;
+    float opacity = 1.0f;
+};
+
+/**
+ * @brief 分块软件光栅化器
+ * 
+ * 每帧先调用 resize()，再把各个网格光栅化到各自的渲染层，最后合成。
+ * 不透明层按深度合成；半透明层内部按从远到近的顺序混合，合成时
+ * 最近片元比不透明表面更近的像素叠加在其上（同一像素上半透明层的片元整体参与比较）。
+ * 
+ * 排序和光栅化之前先剔除：渲染缓存带有该网格版本在后台建好的 AABB 树时，
+ * 整棵子树落在视口外的面及其顶点不被访问；
+ * 封闭网格背向视线的面（屏幕上顺时针）以及退化的面也不进入后续阶段
+ */
+class SoftwareRasterizer
+{
+public:
+    static constexpr int kTileSize = 64;  ///< 块的边长（像素）
+    
+    SoftwareRasterizer() = default;
+    ~SoftwareRasterizer() = default;
+    
+    /**
+     * @brief 按视口调整合成图像的大小
+     */
+    void resize(int width, int height);
+    
+    /**
+     * @brief 渲染层是否已是按这些条件光栅化的结果
+     */
+    bool isCurrent(const RenderLayer& layer, const MeshHandle& mesh, const RasterView& view,
+                   const QColor& color, float opacity = 1.0f, const MR::AffineXf3f* xf = nullptr) const;
+    
+    /**
+     * @brief 把网格光栅化到渲染层（平面着色，亮度取决于面法向与视线的夹角），条件未变时不做任何工作
+     * @param cache 该网格的渲染缓存，跨帧保留
+     * @param xf 绘制前对顶点施加的变换（如刀具位姿），网格本身不变
+     * @return 是否重新光栅化
+     */
+    bool renderLayer(RenderLayer& layer, const MeshHandle& mesh, RenderCache& cache, const RasterView& view,
+                     const QColor& color, float opacity = 1.0f, const MR::AffineXf3f* xf = nullptr);
+    
+    /**
+     * @brief 在背景上合成渲染层：先按深度合成不透明层，再按顺序叠加半透明层
+     */
+    void composite(const std::vector<const RenderLayer*>& layers, const QColor& background);
+    
+    /**
+     * @brief 合成后的图像
+     */
+    const QImage& image() const { return image_; }
+
+private:
+    bool cullFrustum(const MR::AABBTree* tree, const RasterView& view, const MR::AffineXf3f* xf);
+    void cullFaces(RenderCache& cache, bool useCandidates);
+    void binFaces(const RenderCache& cache);
+    void rasterizeTile(const RenderCache& cache, int tile, const QColor& color, float opacity,
+                       QRgb* pixels, float* depth);
+    
+    QImage image_;
+    int tilesX_ = 0;
+    int tilesY_ = 0;
+    
+    // 跨帧复用，避免每帧重新分配
+    std::vector<std::pair<MR::NodeId, bool>> stack_;        ///< 遍历 AABB 树的栈（节点，是否已知在视口内）
+    std::vector<uint32_t> candidates_;                      ///< 视锥剔除后留下的面
+    std::vector<std::vector<uint32_t>> survivors_;          ///< [批次] 通过逐面剔除的面
+    std::vector<std::vector<std::vector<uint32_t>>> bins_;  ///< [批次][块] 覆盖该块的面
+};
@@ -0,0 +1,223 @@
+/**
+ * @file VoxelCutEngine.cpp
+ * @brief 体素（SDF）切割引擎实现
+ */
+
+#include "VoxelCutEngine.h"
+#include <MRMesh/MRMeshPart.h>
+#include <MRMesh/MRAffineXf3.h>
+#include <MRMesh/MRExpected.h>
+#include <MRVoxels/MRVDBConversions.h>
+#include <MRVoxels/MRVDBFloatGrid.h>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // 窄带宽度（体素数）
+    constexpr float kBandWidth = 3.0f;
+    
+    using LeafNode = openvdb::FloatTree::LeafNodeType;
+}
+
+struct VoxelCutEngine::Backup
+{
+    struct Tile
+    {
+        openvdb::Coord origin;
+        float value = 0.0f;
+        bool active = false;
+    };
+    
+    std::vector<LeafNode> leaves;  ///< 切割前已存在的叶节点
+    std::vector<Tile> tiles;       ///< 切割前没有叶节点的位置（瓦片或背景值）
+    MeshHandle meshCache;          ///< 切割前的网格缓存
+};
+
+VoxelCutEngine::VoxelCutEngine(float voxelSize)
+    : voxelSize_(voxelSize)
+{
+}
+
+VoxelCutEngine::~VoxelCutEngine() = default;
+
+void VoxelCutEngine::setVoxelSize(float voxelSize)
+{
+    if (voxelSize != voxelSize_)
+    {
+        voxelSize_ = voxelSize;
+        reset();
+    }
+}
+
+BooleanResult VoxelCutEngine::setStock(const MR::Mesh& stock, const MR::ProgressCallback& cb)
+{
+    BooleanResult result;
+    
+    if (stock.points.empty())
+    {
+        result.errorMsg = "Mesh A is empty";
+        return result;
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    MR::FloatGrid grid = toLevelSet(stock, MR::AffineXf3f(), cb);
+    if (!grid)
+    {
+        result.errorMsg = BooleanOperator::kCanceledMsg;
+        return result;
+    }
+    
+    stock_ = std::move(grid);
+    meshCache_.reset();
+    backup_.reset();
+    cutCount_ = 0;
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    result.durationMs = static_cast<float>(elapsed.count());
+    result.success = true;
+    
+    return result;
+}
+
+void VoxelCutEngine::reset()
+{
+    stock_ = {};
+    meshCache_.reset();
+    backup_.reset();
+    cutCount_ = 0;
+}
+
+BooleanResult VoxelCutEngine::subtract(const MR::Mesh& cutter, const MR::AffineXf3f& xf,
+                                       const MR::ProgressCallback& cb)
+{
+    BooleanResult result;
+    
+    if (!stock_)
+    {
+        result.errorMsg = "Mesh A is empty";
+        return result;
+    }
+    
+    if (cutter.points.empty())
+    {
+        result.errorMsg = "Mesh B is empty";
+        return result;
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    // 刀具只在自身附近生成窄带，耗时与毛坯大小和已切割次数无关
+    MR::FloatGrid cutterGrid = toLevelSet(cutter, xf, cb);
+    if (!cutterGrid)
+    {
+        result.errorMsg = BooleanOperator::kCanceledMsg;
+        return result;
+    }
+    
+    // 做差只改动刀具窄带覆盖的区域：先保存这一区域内毛坯的叶节点，
+    // 之后生成网格失败或被取消时可以撤回，不必复制整个毛坯
+    const openvdb::CoordBBox box = MR::ovdb(*cutterGrid).evalActiveVoxelBoundingBox();
+    auto backup = std::make_unique<Backup>();
+    backup->meshCache = std::move(meshCache_);
+    const openvdb::FloatTree& tree = MR::ovdb(*stock_).tree();
+    const int dim = int(LeafNode::DIM);
+    const openvdb::Coord lo(box.min().x() & ~(dim - 1), box.min().y() & ~(dim - 1), box.min().z() & ~(dim - 1));
+    for (int x = lo.x(); x <= box.max().x(); x += dim)
+    {
+        for (int y = lo.y(); y <= box.max().y(); y += dim)
+        {
+            for (int z = lo.z(); z <= box.max().z(); z += dim)
+            {
+                const openvdb::Coord origin(x, y, z);
+                if (const LeafNode* leaf = tree.probeConstLeaf(origin))
+                {
+                    backup->leaves.push_back(*leaf);
+                }
+                else
+                {
+                    backup->tiles.push_back({origin, tree.getValue(origin), tree.isValueOn(origin)});
+                }
+            }
+        }
+    }
+    
+    // 毛坯修改后不再响应取消
+    stock_ -= cutterGrid;
+    backup_ = std::move(backup);
+    meshCache_.reset();
+    ++cutCount_;
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    result.durationMs = static_cast<float>(elapsed.count());
+    result.success = true;
+    
+    return result;
+}
+
+bool VoxelCutEngine::revertLastCut()
+{
+    if (!stock_ || !backup_)
+    {
+        return false;
+    }
+    
+    // 叶节点原样放回；切割前没有叶节点的位置换回叶节点大小的瓦片
+    openvdb::FloatTree& tree = MR::ovdb(*stock_).tree();
+    for (const LeafNode& leaf : backup_->leaves)
+    {
+        tree.addLeaf(new LeafNode(leaf));
+    }
+    for (const Backup::Tile& tile : backup_->tiles)
+    {
+        tree.addTile(1, tile.origin, tile.value, tile.active);
+    }
+    
+    meshCache_ = std::move(backup_->meshCache);
+    backup_.reset();
+    --cutCount_;
+    return true;
+}
+
+MR::Expected<MeshHandle> VoxelCutEngine::getMesh(const MR::ProgressCallback& cb)
+{
+    if (!stock_)
+    {
+        return MR::unexpected(std::string("Mesh A is empty"));
+    }
+    
+    if (meshCache_)
+    {
+        return meshCache_;
+    }
+    
+    auto mesh = gridToMesh(stock_, cb);
+    if (!mesh.has_value())
+    {
+        return MR::unexpected(std::move(mesh.error()));
+    }
+    
+    meshCache_ = std::move(*mesh);
+    return meshCache_;
+}
+
+MR::Expected<MR::Mesh> VoxelCutEngine::gridToMesh(const MR::FloatGrid& grid, const MR::ProgressCallback& cb) const
+{
+    MR::GridToMeshSettings settings;
+    settings.voxelSize = MR::Vector3f::diagonal(voxelSize_);
+    settings.isoValue = 0.0f;
+    settings.cb = cb;
+    return MR::gridToMesh(grid, settings);
+}
+
+MR::FloatGrid VoxelCutEngine::toLevelSet(const MR::Mesh& mesh, const MR::AffineXf3f& xf,
+                                         const MR::ProgressCallback& cb) const
+{
+    // 所有网格使用相同的体素尺寸，位姿只作用于网格到世界的变换，体素布尔运算才能直接对齐
+    return MR::meshToLevelSet(MR::MeshPart(mesh), xf,
+                              MR::Vector3f::diagonal(voxelSize_), kBandWidth, cb);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file VoxelCutEngine.h
+ * @brief 体素（SDF）切割引擎
+ * 
+ * 把毛坯保存为稀疏的窄带符号距离场，每次切割只是一次体素布尔差，
+ * 耗时与之前切割过多少次无关；只在显示或导出时才生成三角网格
+ */
+
+#pragma once
+
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRProgressCallback.h>
+#include <MRMesh/MRAffineXf3.h>
+#include <MRMesh/MRExpected.h>
+#include <MRVoxels/MRFloatGrid.h>
+#include <memory>
+#include "BooleanOperator.h"
+
+/**
+ * @brief 体素切割引擎类
+ * 
+ * 体素尺寸即精度：越小越精确，内存和耗时也越大
+ */
+class VoxelCutEngine
+{
+public:
+    explicit VoxelCutEngine(float voxelSize = 0.1f);
+    ~VoxelCutEngine();
+    
+    /**
+     * @brief 设置体素尺寸 (mm)，会清除当前毛坯
+     */
+    void setVoxelSize(float voxelSize);
+    
+    /**
+     * @brief 获取体素尺寸 (mm)
+     */
+    float getVoxelSize() const { return voxelSize_; }
+    
+    /**
+     * @brief 用三角网格初始化毛坯
+     * @return success 表示是否成功，mesh 字段不使用
+     */
+    BooleanResult setStock(const MR::Mesh& stock, const MR::ProgressCallback& cb = {});
+    
+    /**
+     * @brief 是否已有毛坯
+     */
+    bool hasStock() const { return bool(stock_); }
+    
+    /**
+     * @brief 清除毛坯
+     */
+    void reset();
+    
+    /**
+     * @brief 从毛坯中就地减去刀具，不生成三角网格
+     * 
+     * 做差前只保存刀具包围盒内毛坯的叶节点，耗时与毛坯大小和已切割次数无关；
+     * 生成刀具窄带时被取消（errorMsg 为 BooleanOperator::kCanceledMsg）毛坯保持不变
+     * 
+     * @param xf 刀具位姿，刀具网格在体素化时才变换到毛坯空间
+     * @return mesh 字段不使用，需要网格时调用 getMesh()
+     */
+    BooleanResult subtract(const MR::Mesh& cutter, const MR::AffineXf3f& xf,
+                           const MR::ProgressCallback& cb = {});
+    
+    /**
+     * @brief 撤回最近一次 subtract()：恢复保存的叶节点（如之后生成网格失败或被取消）
+     * @return 是否有可撤回的切割
+     */
+    bool revertLastCut();
+    
+    /**
+     * @brief 获取毛坯的三角网格，毛坯未改变时直接返回缓存
+     * @return 没有毛坯、转换失败或被取消（stringOperationCanceled()）时返回错误
+     */
+    MR::Expected<MeshHandle> getMesh(const MR::ProgressCallback& cb = {});
+    
+    /**
+     * @brief 自初始化以来的切割次数
+     */
+    int getCutCount() const { return cutCount_; }
+
+private:
+    /**
+     * @brief 最近一次切割前刀具包围盒内毛坯的叶节点和叶节点大小的瓦片
+     */
+    struct Backup;
+    
+    MR::FloatGrid toLevelSet(const MR::Mesh& mesh, const MR::AffineXf3f& xf,
+                             const MR::ProgressCallback& cb) const;
+    MR::Expected<MR::Mesh> gridToMesh(const MR::FloatGrid& grid, const MR::ProgressCallback& cb) const;
+    
+    float voxelSize_ = 0.1f;
+    MR::FloatGrid stock_;
+    MeshHandle meshCache_;
+    std::unique_ptr<Backup> backup_;
+    int cutCount_ = 0;
+};